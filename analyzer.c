@@ -0,0 +1,287 @@
+// --- 离线批量分析工具 ---
+// 对录制的串口原始数据 (SCOPE_RECORD 生成) 做逐帧测量、直方图与异常标记.
+// 与主程序共用 frame_parser.c (解码) 和 measure.c (测量/触发), 不链接 SDL.
+//
+// 文件按字节区间切成若干分片, 每个分片的边界对齐到区间内第一个包头,
+// 由线程池并行解析, 结果按分片顺序合并.
+// 分帧 (包括截断帧的判定) 用 Parser_NextAt, 与主程序的串口解析完全相同.
+// 每个分片记录解析停下的位置, 若与下一分片的起点不一致 (上一包跨过了边界),
+// 合并前从该位置顺序重解下一分片, 因此输出与线程数无关, 与单线程逐字节一致.
+//
+// 录制文件只有接收方向的数据, 不含时基: -t 对整个文件生效.
+// 录制期间切换过时基时 (文件中有命令应答) 会给出警告, 此时周期/频率只对 -t 对应的时段正确.
+//
+// 用法: scope_analyzer [-j 线程数] [-t 时基ms/div] [-o 逐帧.csv] capture.bin
+#include "frame_parser.h"
+#include "measure.h"
+#include "time_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// --- 可调参数 ---
+#define GRID_SIZE            30     // 与主程序一致: 每格像素数
+#define SHARDS_PER_THREAD    4      // 分片数 = 线程数 x 此值, 便于负载均衡
+#define HIST_BUCKETS         64
+#define HIST_BUCKET_MV       64     // 采样值直方图: 0 ~ 4096 mV
+#define FLAT_VPP_MV          10     // 峰峰值低于此值视为无信号
+#define CLIP_MV              3300   // 达到此值视为削顶
+#define FREQ_JUMP_PERCENT    20     // 相邻帧频率变化超过此比例标记
+#define LEVEL_JUMP_PERCENT   25     // 相邻帧均值变化超过上一帧峰峰值的此比例标记
+
+// --- 异常标记 ---
+#define FLAG_FLAT       0x01 // 无信号
+#define FLAG_CLIP       0x02 // 削顶
+#define FLAG_RESYNC     0x04 // 帧前有无法识别的字节
+#define FLAG_FREQ_JUMP  0x08 // 频率突变
+#define FLAG_LEVEL_JUMP 0x10 // 直流电平突变
+
+typedef struct {
+    long offset;     // 包头在文件中的位置
+    int junk_before; // 与上一个包之间无法识别的字节数
+    MeasureResult m;
+    int flags;
+} FrameResult;
+
+typedef struct {
+    long start, end;           // 解析区间 [start, end), 两端都对齐到包头
+    FrameResult* frames;
+    int count, cap;
+    long acks;
+    long skipped_bytes;
+    long stop;                 // 解析实际停下的位置 (最后一个包可能越过 end)
+    int trailing_junk;         // 区间末尾未归属任何帧的字节, 计入下一分片首帧
+    unsigned long hist[HIST_BUCKETS];
+} Shard;
+
+static const uint8_t* file_data = NULL;
+static long file_size = 0;
+static float ms_per_sample = 1.0f / GRID_SIZE;
+
+static Shard* shards = NULL;
+static int shard_count = 0;
+static int next_shard = 0; // 线程池取任务的原子计数
+
+static void shard_push(Shard* sh, const FrameResult* r) {
+    if (sh->count == sh->cap) {
+        sh->cap = sh->cap ? sh->cap * 2 : 256;
+        sh->frames = (FrameResult*)realloc(sh->frames, sh->cap * sizeof(FrameResult));
+        if (!sh->frames) { perror("realloc"); exit(1); }
+    }
+    sh->frames[sh->count++] = *r;
+}
+
+static int is_header(long p) {
+    return file_data[p] == FRAME_SYNC_0 &&
+           (file_data[p + 1] == FRAME_SYNC_DATA || file_data[p + 1] == FRAME_SYNC_ACK);
+}
+
+static void process_shard(Shard* sh) {
+    int samples[FRAME_POINTS];
+    uint16_t ack_seq;
+    long p = sh->start;
+    int junk = 0;
+
+    for (;;) {
+        int junk_was = junk;
+        ParseResult res = Parser_NextAt(file_data, file_size, sh->end, &p, &junk, samples, &ack_seq);
+        sh->skipped_bytes += junk - junk_was;
+        if (res == PARSE_NONE) break; // 到达分片末尾, 或文件末尾不完整的包
+        if (res == PARSE_ACK) {
+            sh->acks++;
+            continue;
+        }
+
+        FrameResult r;
+        r.offset = p - FRAME_SIZE;
+        r.junk_before = junk;
+        Measure_Frame(samples, FRAME_POINTS, ms_per_sample, &r.m);
+        r.flags = 0;
+        if (r.m.max_mv - r.m.min_mv < FLAT_VPP_MV) r.flags |= FLAG_FLAT;
+        if (r.m.max_mv >= CLIP_MV) r.flags |= FLAG_CLIP;
+        shard_push(sh, &r);
+
+        for (int i = 0; i < FRAME_POINTS; i++) {
+            int b = samples[i] / HIST_BUCKET_MV;
+            if (b >= HIST_BUCKETS) b = HIST_BUCKETS - 1;
+            sh->hist[b]++;
+        }
+        junk = 0;
+    }
+    sh->stop = p;
+    sh->trailing_junk = junk;
+}
+
+// 清空分片结果, 改从 start 重新解析 (只在合并阶段顺序调用)
+static void reprocess_shard(Shard* sh, long start) {
+    sh->start = start;
+    sh->count = 0;
+    sh->acks = 0;
+    sh->skipped_bytes = 0;
+    memset(sh->hist, 0, sizeof(sh->hist));
+    process_shard(sh);
+}
+
+// 从 p 开始找第一个包头, 找不到返回 file_size
+static long find_header(long p) {
+    for (; p + FRAME_HEADER_SIZE <= file_size; p++) {
+        if (is_header(p)) return p;
+    }
+    return file_size;
+}
+
+static void* worker_main(void* arg) {
+    (void)arg;
+    for (;;) {
+        int idx = __sync_fetch_and_add(&next_shard, 1);
+        if (idx >= shard_count) break;
+        process_shard(&shards[idx]);
+    }
+    return NULL;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-j threads] [-t ms_per_div] [-o frames.csv] capture.bin\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char* csv_path = NULL;
+    float ms_per_div = 1.0f;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:t:o:h")) != -1) {
+        switch (opt) {
+            case 'j': threads = atoi(optarg); break;
+            case 't': ms_per_div = (float)atof(optarg); break;
+            case 'o': csv_path = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind >= argc || threads <= 0 || ms_per_div <= 0.0f) { usage(argv[0]); return 2; }
+    ms_per_sample = ms_per_div / GRID_SIZE;
+
+    // 1. 映射整个文件
+    int fd = open(argv[optind], O_RDONLY);
+    if (fd < 0) { perror(argv[optind]); return 1; }
+    struct stat st;
+    if (fstat(fd, &st) != 0) { perror("fstat"); return 1; }
+    file_size = (long)st.st_size;
+    if (file_size > 0) {
+        file_data = (const uint8_t*)mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (file_data == MAP_FAILED) { perror("mmap"); return 1; }
+    }
+
+    // 2. 切分片并行处理
+    uint32_t t0 = Time_NowUs();
+    shard_count = threads * SHARDS_PER_THREAD;
+    if (file_size < (long)shard_count * FRAME_SIZE) shard_count = 1;
+    shards = (Shard*)calloc(shard_count, sizeof(Shard));
+    // 分片边界对齐到包头: 相邻分片首尾相接, 每个包恰好属于一个分片
+    // (首个分片从 0 开始, 文件开头的杂散字节也计入统计)
+    for (int i = 0; i < shard_count; i++) {
+        shards[i].start = (i == 0) ? 0 : find_header(file_size * i / shard_count);
+    }
+    for (int i = 0; i < shard_count; i++) {
+        shards[i].end = (i + 1 < shard_count) ? shards[i + 1].start : file_size;
+    }
+    pthread_t* tids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    for (int i = 0; i < threads; i++) pthread_create(&tids[i], NULL, worker_main, NULL);
+    for (int i = 0; i < threads; i++) pthread_join(tids[i], NULL);
+    // 上一分片的最后一个包越过了边界 (例如应答序号里恰好有包头字节), 从它停下处重解
+    long reparsed = 0;
+    for (int i = 1; i < shard_count; i++) {
+        if (shards[i].start != shards[i - 1].stop) {
+            reprocess_shard(&shards[i], shards[i - 1].stop);
+            reparsed++;
+        }
+    }
+    double t_parallel = (Time_NowUs() - t0) / 1e6;
+
+    // 3. 按分片顺序合并; 跨帧异常 (突变) 需要相邻帧, 在合并后顺序标记
+    long total = 0, acks = 0, skipped = 0;
+    unsigned long hist[HIST_BUCKETS];
+    memset(hist, 0, sizeof(hist));
+    for (int i = 0; i < shard_count; i++) {
+        total += shards[i].count;
+        acks += shards[i].acks;
+        skipped += shards[i].skipped_bytes;
+        for (int b = 0; b < HIST_BUCKETS; b++) hist[b] += shards[i].hist[b];
+    }
+
+    FILE* csv = NULL;
+    if (csv_path) {
+        csv = fopen(csv_path, "w");
+        if (!csv) { perror(csv_path); return 1; }
+        fprintf(csv, "frame,offset,min_mv,max_mv,mean_mv,vpp_mv,freq_hz,trigger_idx,flags\n");
+    }
+
+    long flag_counts[5] = {0, 0, 0, 0, 0};
+    const FrameResult* prev = NULL;
+    long frame_no = 0;
+    int carry_junk = 0;
+    for (int i = 0; i < shard_count; i++) {
+        for (int k = 0; k < shards[i].count; k++) {
+            FrameResult* r = &shards[i].frames[k];
+            if (k == 0) r->junk_before += carry_junk;
+            // 文件开头的杂散字节 (录制从半帧开始) 不算异常
+            if (r->junk_before > 0 && prev) r->flags |= FLAG_RESYNC;
+            if (prev) {
+                float pf = prev->m.freq_hz, cf = r->m.freq_hz;
+                if (pf > 0.0f && cf > 0.0f && (cf > pf * (100 + FREQ_JUMP_PERCENT) / 100.0f ||
+                                               cf < pf * (100 - FREQ_JUMP_PERCENT) / 100.0f)) {
+                    r->flags |= FLAG_FREQ_JUMP;
+                }
+                int vpp = prev->m.max_mv - prev->m.min_mv;
+                if (vpp >= FLAT_VPP_MV && abs(r->m.mean_mv - prev->m.mean_mv) * 100 > vpp * LEVEL_JUMP_PERCENT) {
+                    r->flags |= FLAG_LEVEL_JUMP;
+                }
+            }
+            for (int b = 0; b < 5; b++) if (r->flags & (1 << b)) flag_counts[b]++;
+            if (csv) {
+                fprintf(csv, "%ld,%ld,%d,%d,%d,%d,%.3f,%d,%d\n", frame_no, r->offset,
+                        r->m.min_mv, r->m.max_mv, r->m.mean_mv, r->m.max_mv - r->m.min_mv,
+                        r->m.freq_hz, r->m.trigger_idx, r->flags);
+            }
+            prev = r;
+            frame_no++;
+        }
+        carry_junk = (shards[i].count > 0) ? shards[i].trailing_junk : carry_junk + shards[i].trailing_junk;
+    }
+    if (csv) fclose(csv);
+    double t_total = (Time_NowUs() - t0) / 1e6;
+
+    // 4. 汇总
+    printf("file: %s (%ld bytes)\n", argv[optind], file_size);
+    printf("threads: %d, shards: %d (%ld re-parsed at boundaries)\n", threads, shard_count, reparsed);
+    printf("frames: %ld, acks: %ld, resync bytes: %ld\n", total, acks, skipped);
+    printf("time: analyze %.3f s, total %.3f s, %.1f MB/s\n", t_parallel, t_total,
+           t_parallel > 0 ? file_size / t_parallel / 1e6 : 0.0);
+    if (acks > 0) {
+        printf("warning: %ld command acks in capture, the timebase may have changed during recording;\n"
+               "         -t %.3g applies to every frame\n", acks, ms_per_div);
+    }
+    printf("anomalies: flat %ld, clip %ld, resync %ld, freq_jump %ld, level_jump %ld\n",
+           flag_counts[0], flag_counts[1], flag_counts[2], flag_counts[3], flag_counts[4]);
+    printf("sample histogram (mV):\n");
+    unsigned long hmax = 1;
+    for (int b = 0; b < HIST_BUCKETS; b++) if (hist[b] > hmax) hmax = hist[b];
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        if (hist[b] == 0) continue;
+        int bar = (int)(hist[b] * 50 / hmax);
+        printf("%5d-%-5d %10lu ", b * HIST_BUCKET_MV, (b + 1) * HIST_BUCKET_MV - 1, hist[b]);
+        for (int k = 0; k < bar; k++) putchar('#');
+        putchar('\n');
+    }
+
+    for (int i = 0; i < shard_count; i++) free(shards[i].frames);
+    free(shards);
+    free(tids);
+    if (file_data && file_size > 0) munmap((void*)file_data, file_size);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,101 @@
+// --- 离线分析工具一致性检查 ---
+// 生成一段带截断帧、杂散字节和应答包的模拟录制文件, 分别用 -j 1 与多个线程数运行
+// scope_analyzer, 逐字节比较逐帧 CSV 与汇总里的帧数/字节统计, 结果必须完全一致.
+//
+// 用法: analyzer_check ./scope_analyzer   (make analyzer-check)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+
+#define CHECK_FRAMES     4000
+#define TRUNCATE_EVERY   5    // 每隔多少帧截断一帧 (足够密, 分片边界常落在截断处)
+#define JUNK_EVERY       131  // 每隔多少帧插入杂散字节
+#define ACK_EVERY        53   // 每隔多少帧插入应答
+#define FRAME_POINTS     320
+
+static const char* CAPTURE = "analyzer_check.bin";
+static const int THREADS[] = {2, 3, 4, 7, 8, 17};
+
+static uint32_t rng = 12345;
+static uint32_t next_rand(void) {
+    rng = rng * 1103515245u + 12345u;
+    return rng >> 8;
+}
+
+static void put_frame(FILE* fp, int n, int k) {
+    uint8_t buf[2 + FRAME_POINTS * 2];
+    buf[0] = 0xFA; buf[1] = 0xFB;
+    for (int i = 0; i < FRAME_POINTS; i++) {
+        int mv = 1650 + (int)(1000.0 * sin((i + k * 7) * 2.0 * M_PI / (20 + k % 50)));
+        buf[2 + i * 2] = mv & 0xFF;
+        buf[3 + i * 2] = (mv >> 8) & 0xFF;
+    }
+    fwrite(buf, 1, n, fp);
+}
+
+static int write_capture(void) {
+    FILE* fp = fopen(CAPTURE, "wb");
+    if (!fp) { perror(CAPTURE); return -1; }
+    // 从半帧开始录制
+    put_frame(fp, 0, 0);
+    fwrite("\x10\x06\x20", 1, 3, fp);
+    for (int k = 0; k < CHECK_FRAMES; k++) {
+        if (k % TRUNCATE_EVERY == 3) put_frame(fp, 2 + next_rand() % (FRAME_POINTS * 2), k);
+        else put_frame(fp, 2 + FRAME_POINTS * 2, k);
+        if (k % ACK_EVERY == 0) {
+            // 序号里也会出现包头字节 (0xFBFA)
+            uint16_t seq = (k % (ACK_EVERY * 3) == 0) ? 0xFBFA : (uint16_t)k;
+            uint8_t ack[4] = {0xFA, 0xFC, seq & 0xFF, seq >> 8};
+            fwrite(ack, 1, 4, fp);
+        }
+        if (k % JUNK_EVERY == 0) {
+            int n = 1 + next_rand() % 9;
+            for (int i = 0; i < n; i++) fputc(next_rand() & 0xFF, fp);
+        }
+    }
+    return fclose(fp);
+}
+
+// 运行分析工具, 汇总里与线程数/耗时无关的行写到 summary
+static int run(const char* analyzer, int threads, const char* csv, const char* summary) {
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd), "%s -j %d -o %s %s | grep -E '^(frames|anomalies):' > %s",
+             analyzer, threads, csv, CAPTURE, summary);
+    return system(cmd);
+}
+
+static int same_file(const char* a, const char* b) {
+    FILE* fa = fopen(a, "rb");
+    FILE* fb = fopen(b, "rb");
+    int same = fa && fb;
+    while (same) {
+        int ca = fgetc(fa), cb = fgetc(fb);
+        if (ca != cb) same = 0;
+        if (ca == EOF || cb == EOF) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) { fprintf(stderr, "usage: %s ./scope_analyzer\n", argv[0]); return 2; }
+    if (write_capture() != 0) return 1;
+    if (run(argv[1], 1, "analyzer_check_1.csv", "analyzer_check_1.txt") != 0) return 1;
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(THREADS) / sizeof(THREADS[0]); i++) {
+        if (run(argv[1], THREADS[i], "analyzer_check_n.csv", "analyzer_check_n.txt") != 0) return 1;
+        int ok = same_file("analyzer_check_1.csv", "analyzer_check_n.csv") &&
+                 same_file("analyzer_check_1.txt", "analyzer_check_n.txt");
+        printf("-j %-2d %s\n", THREADS[i], ok ? "ok" : "MISMATCH");
+        if (!ok) failed = 1;
+    }
+    remove(CAPTURE);
+    remove("analyzer_check_1.csv"); remove("analyzer_check_1.txt");
+    remove("analyzer_check_n.csv"); remove("analyzer_check_n.txt");
+    printf(failed ? "FAILED\n" : "PASSED\n");
+    return failed;
+}
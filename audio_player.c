@@ -1,73 +1,252 @@
 #include "audio_player.h"
-#include <SDL/SDL.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "time_util.h"
 
-// 音频资源变量
-static Uint8 *audio_chunk = NULL;
-static Uint32 audio_len = 0;
-static Uint8 *audio_pos = NULL;
-static Uint32 audio_len_remaining = 0;
+// --- 音效资源 (设备格式: Sint16, 单声道, AUDIO_FREQ) ---
+typedef struct {
+    Sint16* pcm;
+    int len; // 采样点数
+} AudioClip;
+
+static AudioClip clips[AUDIO_MAX_CLIPS];
+static int clip_count = 0;
+static int device_open = 0;
+static SDL_AudioSpec device_spec;
+
+// --- 声部 (仅音频线程访问) ---
+typedef struct {
+    int clip; // -1 空闲
+    int pos;
+} Voice;
+
+static Voice voices[AUDIO_MAX_VOICES];
+static int next_voice = 0;
+static Sint32* mix_buf = NULL;
+
+// --- 单生产者/单消费者无锁命令队列 ---
+// UI 线程只写 cmd_head, 音频线程只写 cmd_tail
+typedef struct {
+    int clip;
+    Uint32 t_us; // 触发时刻
+} AudioCmd;
+
+static AudioCmd cmd_ring[AUDIO_CMD_QUEUE];
+static volatile unsigned cmd_head = 0;
+static volatile unsigned cmd_tail = 0;
+
+// --- 音调模式 ---
+#define TONE_TABLE_SIZE 256
+static Sint16 tone_table[TONE_TABLE_SIZE];
+static volatile Uint32 tone_step = 0; // 相位增量 (16.16 定点), 0 关闭
+static Uint32 tone_phase = 0;
+
+// --- 延迟统计 (音频线程写, UI 线程读) ---
+static volatile AudioLatency latency;
+static Uint64 latency_sum = 0;
+static Uint32 buffer_us = 0;
+
+static void start_voice(int clip) {
+    // 先找空闲声部, 没有则轮换覆盖最早的
+    int slot = -1;
+    for (int i = 0; i < AUDIO_MAX_VOICES; i++) {
+        if (voices[i].clip < 0) { slot = i; break; }
+    }
+    if (slot < 0) {
+        slot = next_voice;
+        next_voice = (next_voice + 1) % AUDIO_MAX_VOICES;
+    }
+    voices[slot].clip = clip;
+    voices[slot].pos = 0;
+}
+
+static void record_latency(Uint32 trigger_us, Uint32 now) {
+    Uint32 us = (now - trigger_us) + buffer_us;
+    latency.last_us = us;
+    if (us > latency.max_us) latency.max_us = us;
+    latency.count++;
+    latency_sum += us;
+    latency.avg_us = (Uint32)(latency_sum / latency.count);
+}
 
 // SDL 音频回调函数：系统需要数据时自动调用
 static void audio_callback(void *udata, Uint8 *stream, int len) {
-    // 先将缓冲区静音，避免噪音
-    SDL_memset(stream, 0, len);
+    Sint16* out = (Sint16*)stream;
+    int n = len / 2;
 
-    if (audio_len_remaining == 0) return;
+    // 1. 取出 UI 线程投递的播放命令
+    Uint32 now = Time_NowUs();
+    while (cmd_tail != cmd_head) {
+        AudioCmd cmd = cmd_ring[cmd_tail & (AUDIO_CMD_QUEUE - 1)];
+        __sync_synchronize();
+        cmd_tail++;
+        if (cmd.clip >= 0 && cmd.clip < clip_count) {
+            start_voice(cmd.clip);
+            record_latency(cmd.t_us, now);
+        }
+    }
 
-    // 计算实际需要拷贝的长度
-    len = (len > audio_len_remaining ? audio_len_remaining : len);
+    // 2. 混音 (32 位累加, 最后统一限幅)
+    memset(mix_buf, 0, n * sizeof(Sint32));
+    for (int v = 0; v < AUDIO_MAX_VOICES; v++) {
+        Voice* vo = &voices[v];
+        if (vo->clip < 0) continue;
+        const AudioClip* c = &clips[vo->clip];
+        int count = c->len - vo->pos;
+        if (count > n) count = n;
+        const Sint16* src = c->pcm + vo->pos;
+        for (int i = 0; i < count; i++) mix_buf[i] += src[i];
+        vo->pos += count;
+        if (vo->pos >= c->len) vo->clip = -1;
+    }
 
-    // 混合音频数据 (SDL_MIX_MAXVOLUME 确保音量正常)
-    SDL_MixAudio(stream, audio_pos, len, SDL_MIX_MAXVOLUME);
+    Uint32 step = tone_step;
+    if (step) {
+        for (int i = 0; i < n; i++) {
+            mix_buf[i] += tone_table[(tone_phase >> 16) & (TONE_TABLE_SIZE - 1)];
+            tone_phase += step;
+        }
+    }
 
-    // 更新指针和剩余长度
-    audio_pos += len;
-    audio_len_remaining -= len;
+    for (int i = 0; i < n; i++) {
+        Sint32 s = mix_buf[i];
+        if (s > 32767) s = 32767;
+        else if (s < -32768) s = -32768;
+        out[i] = (Sint16)s;
+    }
 }
 
-int Audio_Init(const char* filename) {
-    SDL_AudioSpec wanted_spec;
+int Audio_LoadClip(const char* filename) {
+    if (!device_open || clip_count >= AUDIO_MAX_CLIPS) return -1;
 
-    // 加载 WAV 文件
-    if (SDL_LoadWAV(filename, &wanted_spec, &audio_chunk, &audio_len) == NULL) {
+    SDL_AudioSpec wav_spec;
+    Uint8* wav_buf = NULL;
+    Uint32 wav_len = 0;
+    if (SDL_LoadWAV(filename, &wav_spec, &wav_buf, &wav_len) == NULL) {
         fprintf(stderr, "Audio Load Failed: %s\n", SDL_GetError());
         return -1;
     }
 
-    // 设置回调
+    // 载入时一次性转换为设备格式, 回调里只做整数累加
+    SDL_AudioCVT cvt;
+    if (SDL_BuildAudioCVT(&cvt, wav_spec.format, wav_spec.channels, wav_spec.freq,
+                          device_spec.format, device_spec.channels, device_spec.freq) < 0) {
+        fprintf(stderr, "Audio Convert Failed: %s\n", SDL_GetError());
+        SDL_FreeWAV(wav_buf);
+        return -1;
+    }
+    cvt.len = wav_len;
+    cvt.buf = (Uint8*)malloc(wav_len * cvt.len_mult);
+    if (!cvt.buf) {
+        SDL_FreeWAV(wav_buf);
+        return -1;
+    }
+    memcpy(cvt.buf, wav_buf, wav_len);
+    SDL_FreeWAV(wav_buf);
+    if (cvt.needed) SDL_ConvertAudio(&cvt);
+    else cvt.len_cvt = cvt.len;
+
+    AudioClip* c = &clips[clip_count];
+    c->pcm = (Sint16*)cvt.buf;
+    c->len = cvt.len_cvt / 2;
+
+    // 回调只读 clip_count 以内的音效, 先写好数据再发布
+    SDL_LockAudio();
+    int id = clip_count++;
+    SDL_UnlockAudio();
+    return id;
+}
+
+int Audio_Init(const char* filename) {
+    SDL_AudioSpec wanted_spec;
+    memset(&wanted_spec, 0, sizeof(wanted_spec));
+    wanted_spec.freq = AUDIO_FREQ;
+    wanted_spec.format = AUDIO_S16SYS;
+    wanted_spec.channels = 1;
+    wanted_spec.samples = AUDIO_BUFFER_SAMPLES;
     wanted_spec.callback = audio_callback;
     wanted_spec.userdata = NULL;
 
-    // 打开音频设备
+    // obtained 传 NULL: 由 SDL 保证得到上面要求的格式
     if (SDL_OpenAudio(&wanted_spec, NULL) < 0) {
         fprintf(stderr, "Audio Open Failed: %s\n", SDL_GetError());
-        SDL_FreeWAV(audio_chunk);
         return -1;
     }
+    device_spec = wanted_spec;
+    device_open = 1;
+    buffer_us = (Uint32)((Uint64)device_spec.samples * 1000000u / device_spec.freq);
 
-    audio_len_remaining = 0;
-    audio_pos = audio_chunk;
+    mix_buf = (Sint32*)malloc(device_spec.samples * device_spec.channels * sizeof(Sint32));
+    if (!mix_buf) {
+        Audio_Cleanup();
+        return -1;
+    }
+    for (int i = 0; i < AUDIO_MAX_VOICES; i++) voices[i].clip = -1;
+    for (int i = 0; i < TONE_TABLE_SIZE; i++) {
+        tone_table[i] = (Sint16)(AUDIO_TONE_VOLUME * sin(2.0 * M_PI * i / TONE_TABLE_SIZE));
+    }
 
     // 开始播放（解除暂停状态）
     SDL_PauseAudio(0);
+
+    if (Audio_LoadClip(filename) < 0) return -1;
     return 0;
 }
 
+void Audio_PlayClip(int clip) {
+    if (!device_open || clip < 0 || clip >= clip_count) return;
+
+    // 队列满则丢弃, 不等待音频线程
+    unsigned head = cmd_head;
+    if (head - cmd_tail >= AUDIO_CMD_QUEUE) {
+        latency.dropped++;
+        return;
+    }
+    AudioCmd* cmd = &cmd_ring[head & (AUDIO_CMD_QUEUE - 1)];
+    cmd->clip = clip;
+    cmd->t_us = Time_NowUs();
+    __sync_synchronize();
+    cmd_head = head + 1;
+}
+
 void Audio_Play(void) {
-    if (!audio_chunk) return;
+    Audio_PlayClip(0);
+}
 
-    // 加锁以安全修改回调函数正在使用的变量
-    SDL_LockAudio();
-    audio_pos = audio_chunk;
-    audio_len_remaining = audio_len;
-    SDL_UnlockAudio();
+void Audio_SetTone(float freq_hz) {
+    if (!device_open) return;
+    if (freq_hz <= 0.0f) {
+        tone_step = 0;
+        return;
+    }
+    // 每个输出采样前进 freq * TABLE / rate 格, 16.16 定点
+    tone_step = (Uint32)(freq_hz * TONE_TABLE_SIZE * 65536.0f / device_spec.freq);
+}
+
+void Audio_GetLatency(AudioLatency* out) {
+    out->last_us = latency.last_us;
+    out->avg_us = latency.avg_us;
+    out->max_us = latency.max_us;
+    out->count = latency.count;
+    out->dropped = latency.dropped;
 }
 
 void Audio_Cleanup(void) {
-    SDL_CloseAudio();
-    if (audio_chunk) {
-        SDL_FreeWAV(audio_chunk);
-        audio_chunk = NULL;
+    if (device_open) {
+        SDL_CloseAudio();
+        device_open = 0;
+    }
+    if (latency.count > 0) {
+        printf("Audio latency: avg %u us, max %u us (%u plays)\n",
+               (unsigned)latency.avg_us, (unsigned)latency.max_us, (unsigned)latency.count);
+    }
+    for (int i = 0; i < clip_count; i++) {
+        free(clips[i].pcm);
+        clips[i].pcm = NULL;
     }
+    clip_count = 0;
+    free(mix_buf);
+    mix_buf = NULL;
 }
@@ -1,14 +1,45 @@
 #ifndef AUDIO_PLAYER_H
 #define AUDIO_PLAYER_H
 
+#include <SDL/SDL.h>
+
+// --- 可调参数 ---
+#define AUDIO_FREQ           22050 // 设备采样率
+#define AUDIO_BUFFER_SAMPLES 256   // 设备缓冲 (越小延迟越低, 256 约 11.6ms)
+#define AUDIO_MAX_CLIPS      4     // 最多加载的音效数
+#define AUDIO_MAX_VOICES     4     // 同时发声的音效数
+#define AUDIO_CMD_QUEUE      16    // UI -> 音频线程 命令队列长度 (2 的幂)
+#define AUDIO_TONE_VOLUME    3000  // 音调模式音量 (Sint16 幅度)
+
+// --- 延迟统计 (单位 us) ---
+// 从 Audio_Play 调用到音频回调取走命令, 再加上一个设备缓冲的播放时长
+typedef struct {
+    Uint32 last_us;
+    Uint32 avg_us;
+    Uint32 max_us;
+    Uint32 count;
+    Uint32 dropped; // 队列满被丢弃的命令数
+} AudioLatency;
+
 // 初始化音频系统，加载音效文件
-// filename: wav文件名
+// filename: wav文件名 (作为 0 号音效)
 // 返回: 0 成功, -1 失败
 int Audio_Init(const char* filename);
 
-// 播放音效
-// 如果正在播放，会重置并重新播放
+// 加载额外音效, 载入时一次性转换为设备格式
+// 返回: 音效编号, -1 失败
+int Audio_LoadClip(const char* filename);
+
+// 播放音效 (0 号)
+// 多次触发会叠加播放, 超出 AUDIO_MAX_VOICES 时替换最早的声部
 void Audio_Play(void);
+void Audio_PlayClip(int clip);
+
+// 音调模式: 持续输出指定频率的正弦波, freq_hz <= 0 关闭
+// 只写一个参数, 不加锁, 可在渲染循环里每帧调用
+void Audio_SetTone(float freq_hz);
+
+void Audio_GetLatency(AudioLatency* out);
 
 // 清理音频资源
 void Audio_Cleanup(void);
@@ -0,0 +1,128 @@
+#include "cmd_channel.h"
+#include "serial_hal.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+// --- 命令定义表 ---
+typedef struct {
+    const char* tag;        // 发送前缀
+    int invalidates_frames; // 应答前的波形帧是否作废
+} CmdDef;
+
+static const CmdDef cmd_defs[CMD_COUNT] = {
+    { "TIM", 1 },
+};
+
+// --- 每类命令的状态 ---
+typedef struct {
+    int has_pending;  // 有待发送的值
+    int pending_value;
+    int waiting;      // 已发出, 等待应答
+    uint16_t seq;
+    Uint32 sent_time;
+} CmdSlot;
+
+static CmdSlot slots[CMD_COUNT];
+static uint16_t next_seq = 1;
+
+static uint8_t tx_buf[CMD_TX_BUF_SIZE];
+static int tx_len = 0;
+
+static CmdStats stats;
+static Uint32 rtt_sum = 0;
+
+void Cmd_Reset(void) {
+    memset(slots, 0, sizeof(slots));
+    tx_len = 0;
+}
+
+void Cmd_Post(CmdId id, int value) {
+    if (id < 0 || id >= CMD_COUNT) return;
+    CmdSlot* s = &slots[id];
+    if (s->has_pending) stats.coalesced++;
+    s->has_pending = 1;
+    s->pending_value = value;
+}
+
+// 格式化命令并放入发送队列, 队列满时返回 -1 (下轮再试)
+static int enqueue(CmdId id, int value, uint16_t seq) {
+    char line[32];
+    // 序号跟在值后面, 旧固件按 atoi 解析仍能拿到正确的值
+    int len = snprintf(line, sizeof(line), "%s:%d,%u\n", cmd_defs[id].tag, value, (unsigned)seq);
+    if (len <= 0 || len >= (int)sizeof(line)) return -1;
+    if (tx_len + len > CMD_TX_BUF_SIZE) return -1;
+    memcpy(tx_buf + tx_len, line, len);
+    tx_len += len;
+    return 0;
+}
+
+void Cmd_Poll(int fd) {
+    if (fd < 0) return;
+    Uint32 now = SDL_GetTicks();
+
+    // 1. 超时处理
+    for (int i = 0; i < CMD_COUNT; i++) {
+        CmdSlot* s = &slots[i];
+        if (s->waiting && now - s->sent_time > CMD_ACK_TIMEOUT_MS) {
+            s->waiting = 0;
+            stats.timeouts++;
+        }
+    }
+
+    // 2. 同类命令无在途时才发送最新值, 实现按键连发的合并
+    for (int i = 0; i < CMD_COUNT; i++) {
+        CmdSlot* s = &slots[i];
+        if (!s->has_pending || s->waiting) continue;
+        uint16_t seq = next_seq;
+        if (enqueue((CmdId)i, s->pending_value, seq) != 0) break;
+        next_seq = (uint16_t)(next_seq + 1);
+        if (next_seq == 0) next_seq = 1; // 0 保留不用
+        s->has_pending = 0;
+        s->waiting = 1;
+        s->seq = seq;
+        s->sent_time = now;
+    }
+
+    // 3. 非阻塞写出, 短写时保留剩余部分
+    if (tx_len > 0) {
+        int n = serial_write_bytes(fd, tx_buf, tx_len);
+        if (n > 0) {
+            if (n < tx_len) memmove(tx_buf, tx_buf + n, tx_len - n);
+            tx_len -= n;
+        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            fprintf(stderr, "Cmd write failed: %s\n", strerror(errno));
+            tx_len = 0;
+        }
+    }
+}
+
+void Cmd_OnAck(uint16_t seq) {
+    Uint32 now = SDL_GetTicks();
+    for (int i = 0; i < CMD_COUNT; i++) {
+        CmdSlot* s = &slots[i];
+        if (!s->waiting || s->seq != seq) continue;
+        s->waiting = 0;
+
+        Uint32 rtt = now - s->sent_time;
+        stats.last_rtt = rtt;
+        if (stats.acked == 0 || rtt < stats.min_rtt) stats.min_rtt = rtt;
+        if (rtt > stats.max_rtt) stats.max_rtt = rtt;
+        stats.acked++;
+        rtt_sum += rtt;
+        stats.avg_rtt = rtt_sum / stats.acked;
+        return;
+    }
+}
+
+int Cmd_FramesValid(void) {
+    // 已投递但尚未发出的命令同样作废: 这期间解析出的帧仍是旧参数, 而界面已换成新参数
+    for (int i = 0; i < CMD_COUNT; i++) {
+        if ((slots[i].has_pending || slots[i].waiting) && cmd_defs[i].invalidates_frames) return 0;
+    }
+    return 1;
+}
+
+void Cmd_GetStats(CmdStats* out) {
+    *out = stats;
+}
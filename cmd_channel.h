@@ -0,0 +1,48 @@
+#ifndef CMD_CHANNEL_H
+#define CMD_CHANNEL_H
+
+#include <SDL/SDL.h>
+#include <stdint.h>
+
+// --- 可调参数 ---
+#define CMD_ACK_TIMEOUT_MS 300   // 超时未收到应答则放弃等待 (兼容不回应答的旧固件)
+#define CMD_TX_BUF_SIZE    128   // 发送队列字节数
+
+// --- 命令类型 ---
+// 新增命令: 在这里加枚举, 并在 cmd_channel.c 的 cmd_defs 表中登记前缀
+typedef enum {
+    CMD_TIMEBASE, // TIM:<idx>
+    CMD_COUNT
+} CmdId;
+
+// --- 往返延迟统计 (单位 ms) ---
+typedef struct {
+    Uint32 last_rtt;
+    Uint32 min_rtt;
+    Uint32 max_rtt;
+    Uint32 avg_rtt;
+    Uint32 acked;     // 收到应答的命令数
+    Uint32 timeouts;  // 超时的命令数
+    Uint32 coalesced; // 被后续同类命令合并掉的次数
+} CmdStats;
+
+// --- 接口函数 ---
+// 串口 (重新) 打开后调用, 清空队列与等待状态
+void Cmd_Reset(void);
+
+// 投递命令 (不阻塞)
+// 同类命令在发送前会被合并, 只发最新的值; 同类命令同一时刻最多一条在途
+void Cmd_Post(CmdId id, int value);
+
+// 主循环每轮调用: 检查超时, 把待发命令写入串口 (非阻塞, 处理短写)
+void Cmd_Poll(int fd);
+
+// 解析到应答帧时调用
+void Cmd_OnAck(uint16_t seq);
+
+// 返回 0 表示有改变采样参数的命令尚未发出或尚未应答, 此时收到的波形帧应丢弃
+int Cmd_FramesValid(void);
+
+void Cmd_GetStats(CmdStats* out);
+
+#endif
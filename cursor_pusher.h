@@ -24,5 +24,6 @@ int Pusher_Init(void);
 void Pusher_Cleanup(void);
 void Pusher_OnMove(CursorType type, int current_val, int delta);
 void Pusher_Render(SDL_Surface* screen);
+int Pusher_IsVisible(void);
 
 #endif
\ No newline at end of file
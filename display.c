@@ -0,0 +1,249 @@
+#include "display.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "time_util.h"
+#include <linux/fb.h>
+
+// --- 后端状态 ---
+static SDL_Surface* video = NULL;  // SDL 窗口表面
+static SDL_Surface* target = NULL; // 渲染目标 (SDL 后端即 video)
+
+static int fb_fd = -1;
+static int fb_is_file = 0;         // 模拟 framebuffer
+static Uint8* fb_mem = NULL;
+static size_t fb_size = 0;
+static int fb_pitch = 0;
+static int fb_pages = 1;
+static int fb_front = 0;           // 当前显示的页
+static struct fb_var_screeninfo fb_var;
+
+// --- 脏矩形 ---
+typedef struct {
+    SDL_Rect rects[DISPLAY_MAX_DIRTY];
+    int count;
+    int full;
+} DirtyList;
+
+static DirtyList dirty;      // 本帧
+static DirtyList prev_dirty; // 上一帧 (双缓冲时后台页落后两帧, 需要一并补上)
+
+// --- 统计 ---
+static Uint32 stat_frames = 0;
+static Uint32 stat_us = 0;
+static Uint64 stat_bytes = 0;
+
+static void dirty_add(DirtyList* d, const SDL_Rect* r) {
+    if (d->full) return;
+    if (!r) { d->full = 1; return; }
+
+    // 裁剪到屏幕
+    int x0 = r->x, y0 = r->y, x1 = r->x + r->w, y1 = r->y + r->h;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > target->w) x1 = target->w;
+    if (y1 > target->h) y1 = target->h;
+    if (x1 <= x0 || y1 <= y0) return;
+
+    if (d->count >= DISPLAY_MAX_DIRTY) { d->full = 1; return; }
+    SDL_Rect* o = &d->rects[d->count++];
+    o->x = x0; o->y = y0; o->w = x1 - x0; o->h = y1 - y0;
+}
+
+// --- framebuffer 后端 ---
+static void fb_copy_rect(int page, const SDL_Rect* r) {
+    const Uint8* src = (const Uint8*)target->pixels + r->y * target->pitch + r->x * 2;
+    Uint8* dst = fb_mem + (size_t)page * target->h * fb_pitch + r->y * fb_pitch + r->x * 2;
+    int bytes = r->w * 2;
+    for (int y = 0; y < r->h; y++) {
+        memcpy(dst, src, bytes);
+        src += target->pitch;
+        dst += fb_pitch;
+    }
+    stat_bytes += (Uint64)bytes * r->h;
+}
+
+static void fb_copy_list(int page, const DirtyList* d) {
+    if (d->full) {
+        SDL_Rect all = { 0, 0, target->w, target->h };
+        fb_copy_rect(page, &all);
+        return;
+    }
+    for (int i = 0; i < d->count; i++) fb_copy_rect(page, &d->rects[i]);
+}
+
+static int fb_open(const char* path, int w, int h) {
+    fb_fd = open(path, O_RDWR);
+    if (fb_fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fb_fd, &st) != 0) return -1;
+
+    if (S_ISREG(st.st_mode)) {
+        // 模拟 framebuffer: 普通文件, 两页, 翻页只记录在内存里
+        fb_is_file = 1;
+        fb_pitch = w * 2;
+        fb_pages = 2;
+        fb_size = (size_t)fb_pitch * h * fb_pages;
+        if (ftruncate(fb_fd, fb_size) != 0) return -1;
+    } else {
+        struct fb_fix_screeninfo fix;
+        if (ioctl(fb_fd, FBIOGET_VSCREENINFO, &fb_var) != 0) return -1;
+        if (ioctl(fb_fd, FBIOGET_FSCREENINFO, &fix) != 0) return -1;
+        if (fb_var.bits_per_pixel != 16 || (int)fb_var.xres < w || (int)fb_var.yres < h) {
+            fprintf(stderr, "Display: unsupported fb mode %ux%u@%u\n",
+                    fb_var.xres, fb_var.yres, fb_var.bits_per_pixel);
+            return -1;
+        }
+
+        // 尝试申请两页虚拟高度用于翻页
+        fb_pages = 1;
+        if (fb_var.yres_virtual < fb_var.yres * 2) {
+            struct fb_var_screeninfo v = fb_var;
+            v.yres_virtual = v.yres * 2;
+            if (ioctl(fb_fd, FBIOPUT_VSCREENINFO, &v) == 0) {
+                ioctl(fb_fd, FBIOGET_VSCREENINFO, &fb_var);
+                ioctl(fb_fd, FBIOGET_FSCREENINFO, &fix);
+            }
+        }
+        if (fb_var.yres_virtual >= fb_var.yres * 2 && fix.smem_len >= fix.line_length * fb_var.yres * 2) fb_pages = 2;
+        // 两页按屏幕高度 h 排布, 与真实 yres 不一致时无法翻页
+        if ((int)fb_var.yres != h) fb_pages = 1;
+
+        fb_pitch = fix.line_length;
+        fb_size = fix.smem_len;
+    }
+
+    fb_mem = (Uint8*)mmap(NULL, fb_size, PROT_READ | PROT_WRITE, MAP_SHARED, fb_fd, 0);
+    if (fb_mem == MAP_FAILED) {
+        fb_mem = NULL;
+        return -1;
+    }
+
+    if (!fb_is_file && fb_pages == 2) {
+        fb_var.yoffset = 0;
+        if (ioctl(fb_fd, FBIOPAN_DISPLAY, &fb_var) != 0) fb_pages = 1;
+    }
+    fb_front = 0;
+    return 0;
+}
+
+static void fb_close(void) {
+    if (fb_mem) munmap(fb_mem, fb_size);
+    if (fb_fd >= 0) close(fb_fd);
+    fb_mem = NULL;
+    fb_fd = -1;
+}
+
+static void fb_present(void) {
+    if (fb_pages == 1) {
+        fb_copy_list(0, &dirty);
+        return;
+    }
+
+    // 后台页停留在两帧前: 补上上一帧和本帧的变化后翻页
+    int back = 1 - fb_front;
+    if (prev_dirty.full || dirty.full) {
+        DirtyList all;
+        all.count = 0;
+        all.full = 1;
+        fb_copy_list(back, &all);
+    } else {
+        fb_copy_list(back, &prev_dirty);
+        fb_copy_list(back, &dirty);
+    }
+
+    if (!fb_is_file) {
+        fb_var.yoffset = back * target->h;
+        if (ioctl(fb_fd, FBIOPAN_DISPLAY, &fb_var) != 0) {
+            // 翻页失败: 退回单缓冲, 下一帧整屏刷新
+            fb_pages = 1;
+            fb_var.yoffset = 0;
+            ioctl(fb_fd, FBIOPAN_DISPLAY, &fb_var);
+            dirty.full = 1;
+            fb_copy_list(0, &dirty);
+            return;
+        }
+    }
+    fb_front = back;
+}
+
+// --- SDL 后端 ---
+static void sdl_present(void) {
+    if (dirty.full) {
+        SDL_Flip(video);
+        stat_bytes += (Uint64)video->pitch * video->h;
+        return;
+    }
+    if (dirty.count == 0) return;
+    SDL_UpdateRects(video, dirty.count, dirty.rects);
+    for (int i = 0; i < dirty.count; i++) stat_bytes += (Uint64)dirty.rects[i].w * dirty.rects[i].h * 2;
+}
+
+// --- 接口函数 ---
+SDL_Surface* Display_Open(SDL_Surface* video_surface) {
+    video = video_surface;
+    target = video;
+    memset(&dirty, 0, sizeof(dirty));
+    memset(&prev_dirty, 0, sizeof(prev_dirty));
+    dirty.full = 1;
+    prev_dirty.full = 1;
+
+    const char* fb_path = getenv("SCOPE_FBDEV");
+    if (!fb_path || !*fb_path || !video) return video;
+
+    SDL_Surface* shadow = SDL_CreateRGBSurface(SDL_SWSURFACE, video->w, video->h, 16,
+                                               0xF800, 0x07E0, 0x001F, 0);
+    if (!shadow) return video;
+    target = shadow;
+    if (fb_open(fb_path, video->w, video->h) != 0) {
+        fprintf(stderr, "Display: %s unavailable, using SDL\n", fb_path);
+        fb_close();
+        SDL_FreeSurface(shadow);
+        target = video;
+        return video;
+    }
+    printf("Display: framebuffer %s, %d page(s)%s\n", fb_path, fb_pages, fb_is_file ? " (file)" : "");
+    return target;
+}
+
+void Display_MarkDirty(const SDL_Rect* rect) {
+    if (!target) return;
+    dirty_add(&dirty, rect);
+}
+
+void Display_Present(void) {
+    if (!target) return;
+    Uint32 t0 = Time_NowUs();
+    if (fb_mem) fb_present();
+    else sdl_present();
+    stat_us += Time_NowUs() - t0;
+    stat_frames++;
+
+    prev_dirty = dirty;
+    dirty.count = 0;
+    dirty.full = 0;
+}
+
+void Display_Close(void) {
+    if (stat_frames > 0) {
+        printf("Display: %u frames, avg %u us/present, avg %u bytes/frame\n",
+               (unsigned)stat_frames, (unsigned)(stat_us / stat_frames),
+               (unsigned)(stat_bytes / stat_frames));
+    }
+    if (fb_mem) {
+        fb_close();
+        if (target && target != video) SDL_FreeSurface(target);
+    }
+    target = NULL;
+    video = NULL;
+}
+
+int Display_IsFramebuffer(void) {
+    return fb_mem != NULL;
+}
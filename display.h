@@ -0,0 +1,33 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <SDL/SDL.h>
+
+// --- 显示后端 ---
+// 渲染统一画到 Display_Open 返回的 16 位 (RGB565) 表面上, 由 Display_Present 送显.
+// 后端选择:
+//   环境变量 SCOPE_FBDEV 指向 framebuffer 设备 (如 /dev/fb0) 时直接 mmap 显存,
+//   支持双缓冲翻页 (FBIOPAN_DISPLAY), 不支持翻页时退化为单缓冲;
+//   指向已存在的普通文件时作为模拟 framebuffer (两页), 用于在 PC 上测试与跑分;
+//   未设置或打开失败时使用 SDL 后端.
+
+#define DISPLAY_MAX_DIRTY 16 // 每帧最多记录的脏矩形, 超出按全屏处理
+
+// 打开显示, 必须在 SDL_SetVideoMode 之后调用 (SDL 仍负责按键事件)
+// video: SDL_SetVideoMode 返回的表面
+// 返回: 渲染目标表面
+SDL_Surface* Display_Open(SDL_Surface* video);
+
+// 登记本帧变化的区域, rect 为 NULL 表示整屏
+void Display_MarkDirty(const SDL_Rect* rect);
+
+// 把本帧的脏区域送显, 并清空脏列表
+void Display_Present(void);
+
+// 关闭显示并打印送显统计
+void Display_Close(void);
+
+// 1: 当前使用 framebuffer 后端
+int Display_IsFramebuffer(void);
+
+#endif
@@ -0,0 +1,61 @@
+#include "feature_index.h"
+
+static void add(FeatureIndex* fi, int pos, FeatureKind kind) {
+    if (fi->count >= FEATURE_MAX) return;
+    fi->pos[fi->count] = (short)pos;
+    fi->kind[fi->count] = (unsigned char)kind;
+    fi->count++;
+}
+
+void Feature_Build(FeatureIndex* fi, const int* samples, int n, int lo, int hi) {
+    fi->count = 0;
+    if (n <= 0 || lo >= hi) return;
+
+    // 状态: 1 高于 hi 之后, -1 低于 lo 之后, 0 尚未离开迟滞带
+    int mid = lo + (hi - lo) / 2;
+    int level = 0;
+    int ext_idx = 0;               // 当前半周期的极值位置 (高段为峰, 低段为谷)
+    int last_below = -1, last_above = -1; // 最近一个低于 / 不低于中值的点
+    for (int i = 0; i < n; i++) {
+        int v = samples[i];
+        if (level >= 0 && v < lo) {
+            // 下降沿: 先记上一段的峰 (位置更靠前), 边沿取最后越过中值处
+            if (level > 0) {
+                if (ext_idx > 0) add(fi, ext_idx, FEAT_PEAK);
+                add(fi, last_above + 1, FEAT_FALL);
+            }
+            level = -1;
+            ext_idx = i;
+        } else if (level <= 0 && v > hi) {
+            if (level < 0) {
+                if (ext_idx > 0) add(fi, ext_idx, FEAT_TROUGH);
+                add(fi, last_below + 1, FEAT_RISE);
+            }
+            level = 1;
+            ext_idx = i;
+        } else if ((level > 0 && v > samples[ext_idx]) || (level < 0 && v < samples[ext_idx])) {
+            ext_idx = i;
+        }
+        if (v < mid) last_below = i; else last_above = i;
+    }
+    // 最后半段的极值若不在帧边界上也是真实的峰/谷
+    if (level != 0 && ext_idx > 0 && ext_idx < n - 1) add(fi, ext_idx, level > 0 ? FEAT_PEAK : FEAT_TROUGH);
+}
+
+int Feature_Next(const FeatureIndex* fi, int x) {
+    int lo = 0, hi = fi->count; // 找第一个 pos > x
+    while (lo < hi) {
+        int m = (lo + hi) / 2;
+        if (fi->pos[m] > x) hi = m; else lo = m + 1;
+    }
+    return (lo < fi->count) ? lo : -1;
+}
+
+int Feature_Prev(const FeatureIndex* fi, int x) {
+    int lo = 0, hi = fi->count; // 找第一个 pos >= x, 前一个即所求
+    while (lo < hi) {
+        int m = (lo + hi) / 2;
+        if (fi->pos[m] >= x) hi = m; else lo = m + 1;
+    }
+    return lo - 1;
+}
@@ -0,0 +1,31 @@
+#ifndef FEATURE_INDEX_H
+#define FEATURE_INDEX_H
+
+// --- 波形特征索引 ---
+// 每帧一遍扫描记录边沿 (过中值) 与每个半周期的峰/谷位置, 按位置升序存放,
+// 光标跳转时二分查找下一个/上一个特征. 不依赖 SDL.
+
+#define FEATURE_MAX 512 // 每帧最多记录的特征数, 超出的丢弃
+
+typedef enum {
+    FEAT_RISE,
+    FEAT_FALL,
+    FEAT_PEAK,
+    FEAT_TROUGH
+} FeatureKind;
+
+typedef struct {
+    int count;
+    short pos[FEATURE_MAX];          // 采样位置, 升序
+    unsigned char kind[FEATURE_MAX]; // FeatureKind
+} FeatureIndex;
+
+// lo/hi: 迟滞门限 (mV), 取自 Measure_Frame 的均值与峰峰值, 不再单独统计;
+// lo >= hi 时视为无有效信号, 索引为空
+void Feature_Build(FeatureIndex* fi, const int* samples, int n, int lo, int hi);
+
+// 返回位置严格大于 / 小于 x 的第一个特征的下标, 没有时返回 -1
+int Feature_Next(const FeatureIndex* fi, int x);
+int Feature_Prev(const FeatureIndex* fi, int x);
+
+#endif
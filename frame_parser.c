@@ -0,0 +1,93 @@
+#include "frame_parser.h"
+#include <string.h>
+
+void Parser_Reset(FrameParser* p) {
+    p->len = 0;
+    p->pos = 0;
+    p->junk = 0;
+    p->junk_before = 0;
+}
+
+uint8_t* Parser_WritePtr(FrameParser* p) {
+    return p->buf + p->len;
+}
+
+int Parser_Space(const FrameParser* p) {
+    return (int)sizeof(p->buf) - p->len;
+}
+
+void Parser_Commit(FrameParser* p, int n) {
+    if (n > 0) p->len += n;
+}
+
+void Parser_DecodeFrame(const uint8_t* d, int* samples) {
+    for (int i = 0; i < FRAME_POINTS; i++) {
+        samples[i] = (int)((uint16_t)d[0] | ((uint16_t)d[1] << 8));
+        d += 2;
+    }
+}
+
+// 把未消费的数据搬回缓冲区开头 (每轮解析只搬一次, 不再逐字节 memmove)
+static void compact(FrameParser* p) {
+    int remaining = p->len - p->pos;
+    if (remaining > 0 && p->pos > 0) memmove(p->buf, p->buf + p->pos, remaining);
+    p->len = remaining;
+    p->pos = 0;
+}
+
+// 帧数据区内 (包头之后, 至多到 len) 下一个包头的位置, 没有返回 -1
+static long header_inside_frame(const uint8_t* buf, long len, long p) {
+    long last = p + FRAME_SIZE;
+    if (last > len) last = len;
+    for (long q = p + FRAME_HEADER_SIZE; q + 1 < last; q++) {
+        if (buf[q] == FRAME_SYNC_0 && (buf[q + 1] == FRAME_SYNC_DATA || buf[q + 1] == FRAME_SYNC_ACK)) return q;
+    }
+    return -1;
+}
+
+ParseResult Parser_NextAt(const uint8_t* buf, long len, long limit, long* pos, int* junk,
+                          int* samples, uint16_t* ack_seq) {
+    long p = *pos;
+    while (p < limit && len - p >= FRAME_HEADER_SIZE) {
+        const uint8_t* h = buf + p;
+        long avail = len - p;
+
+        if (h[0] == FRAME_SYNC_0 && h[1] == FRAME_SYNC_DATA) {
+            // 被截断的帧: 只由字节内容决定, 与数据分几次到达、分片怎么切无关
+            long q = header_inside_frame(buf, len, p);
+            if (q >= 0) {
+                *junk += (int)(q - p);
+                p = q;
+                continue;
+            }
+            if (avail < FRAME_SIZE) break; // 等待剩余数据
+            Parser_DecodeFrame(h + FRAME_HEADER_SIZE, samples);
+            *pos = p + FRAME_SIZE;
+            return PARSE_FRAME;
+        }
+        if (h[0] == FRAME_SYNC_0 && h[1] == FRAME_SYNC_ACK) {
+            if (avail < ACK_SIZE) break;
+            *ack_seq = (uint16_t)h[2] | ((uint16_t)h[3] << 8);
+            *pos = p + ACK_SIZE;
+            return PARSE_ACK;
+        }
+        // 未同步, 丢弃一个字节继续找包头
+        p++;
+        (*junk)++;
+    }
+    *pos = p;
+    return PARSE_NONE;
+}
+
+ParseResult Parser_Next(FrameParser* p, int* samples, uint16_t* ack_seq) {
+    long pos = p->pos;
+    ParseResult res = Parser_NextAt(p->buf, p->len, p->len, &pos, &p->junk, samples, ack_seq);
+    p->pos = (int)pos;
+    if (res != PARSE_NONE) {
+        p->junk_before = p->junk;
+        p->junk = 0;
+        return res;
+    }
+    compact(p);
+    return PARSE_NONE;
+}
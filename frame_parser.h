@@ -0,0 +1,57 @@
+#ifndef FRAME_PARSER_H
+#define FRAME_PARSER_H
+#include <stdint.h>
+
+// --- 串口协议 (ESP32 -> 掌机) ---
+// 波形帧: 0xFA 0xFB + FRAME_POINTS 个 uint16 (小端, 单位 mV)
+// 应答帧: 0xFA 0xFC + uint16 序号 (小端), 设备执行完命令后回送
+#define FRAME_SYNC_0      0xFA
+#define FRAME_SYNC_DATA   0xFB
+#define FRAME_SYNC_ACK    0xFC
+
+#define FRAME_HEADER_SIZE 2
+#define FRAME_POINTS      320
+#define FRAME_DATA_SIZE   (FRAME_POINTS * 2)
+#define FRAME_SIZE        (FRAME_HEADER_SIZE + FRAME_DATA_SIZE)
+#define ACK_SIZE          (FRAME_HEADER_SIZE + 2)
+
+typedef enum {
+    PARSE_NONE,  // 缓冲区内没有完整的包
+    PARSE_FRAME, // 解出一帧波形
+    PARSE_ACK    // 解出一个命令应答
+} ParseResult;
+
+typedef struct {
+    uint8_t buf[FRAME_SIZE * 2];
+    int len; // 缓冲区内有效字节数
+    int pos; // 已消费的字节数
+    int junk;        // 自上一个包以来丢弃的字节数
+    int junk_before; // 最近返回的包之前丢弃的字节数, >0 说明中间有数据丢失
+} FrameParser;
+
+void Parser_Reset(FrameParser* p);
+
+// 串口数据直接读入解析器的空闲区, 然后调用 Parser_Commit 登记长度
+uint8_t* Parser_WritePtr(FrameParser* p);
+int Parser_Space(const FrameParser* p);
+void Parser_Commit(FrameParser* p, int n);
+
+// 解码一帧的数据区 (包头之后的 FRAME_DATA_SIZE 字节) 到 samples
+// 离线分析工具直接在整块文件上定位包头时使用
+void Parser_DecodeFrame(const uint8_t* payload, int* samples);
+
+// 在内存缓冲区 buf[0, len) 中从 *pos 起取下一个包, 串口解析与离线分析共用这一套分帧规则.
+// 包头只在 [*pos, limit) 内查找, 找到的包可以越过 limit (离线分析按分片调用时需要).
+// 有效采样值远小于 0xFA00 mV, 完整帧的数据区内不会出现包头字节序列;
+// 数据区里出现包头说明该帧被截断 (串口丢字节, 跨会话追加录制), 截断部分按杂散字节处理.
+// 返回包时 *pos 指向包之后; PARSE_NONE 时 *pos 停在未收全的包头或 limit 处.
+// 丢弃的字节累加到 *junk, 由调用者清零
+ParseResult Parser_NextAt(const uint8_t* buf, long len, long limit, long* pos, int* junk,
+                          int* samples, uint16_t* ack_seq);
+
+// 取出下一个包, 循环调用直到返回 PARSE_NONE
+// samples: 至少 FRAME_POINTS 个元素, 仅 PARSE_FRAME 时写入
+// ack_seq: 仅 PARSE_ACK 时写入
+ParseResult Parser_Next(FrameParser* p, int* samples, uint16_t* ack_seq);
+
+#endif
@@ -9,6 +9,18 @@
 #include "font.h" 
 #include "cursor_pusher.h" // 引入小人推光标模块
 #include "audio_player.h"  // 引入音频模块
+#include "frame_parser.h"  // 串口帧解析
+#include "cmd_channel.h"   // 异步命令通道
+#include "measure.h"       // 自动测量
+#include "display.h"       // 显示后端 (SDL / framebuffer)
+#include "stream_server.h" // 数据流推送服务
+#include "snapshot.h"      // 后台截图导出
+#include "proto_decode.h"  // 串行协议解码
+#include "mask_test.h"     // 模板测试
+#include "stats.h"         // 长时间统计
+#include "feature_index.h" // 光标吸附用的波形特征索引
+#include "xy_plot.h"       // XY 显示
+#include "time_util.h"     // 微秒计时
 
 // --- 基础配置 ---
 #define SCREEN_WIDTH  320
@@ -24,6 +36,23 @@
 #define MEASURE_WIN_X   (SCREEN_WIDTH - MEASURE_WIN_W - 2)
 #define MEASURE_WIN_Y   2
 #define MEASURE_WIN_ALPHA 128 // 测量窗口背景透明度 (0:全透 - 255:不透)
+#define STATUS_MSG_MS   1500  // 状态栏提示显示时长
+#define PROTO_PANEL_LINES 6   // 解码列表显示行数
+#define PROTO_PANEL_W   84
+#define PROTO_PANEL_H   ((PROTO_PANEL_LINES + 1) * 8 + 4)
+#define PROTO_PANEL_X   2
+#define PROTO_PANEL_Y   (SCREEN_HEIGHT - 22 - PROTO_PANEL_H)
+#define PROTO_TAG_GAP   10    // 解码标注位于波形上方的距离
+#define MASK_INFO_X     12    // 模板测试计数显示位置
+#define MASK_INFO_Y     2
+#define MASK_INFO_W     108
+#define MASK_INFO_H     18
+#define STATS_WIN_X     30    // 统计直方图窗口
+#define STATS_WIN_Y     24
+#define STATS_WIN_W     260
+#define STATS_WIN_H     150
+#define STATS_BAR_W     7     // 每个直方图桶的宽度 (像素)
+#define STATS_BAR_H     80    // 直方图最大高度
 
 // --- 颜色定义 ---
 #define RGB565(r, g, b) ((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3))
@@ -42,6 +71,8 @@
 #define COLOR_ALERT_BG  RGB565(50, 0, 0)      
 #define COLOR_ZERO_LINE RGB565(0, 100, 255)
 #define COLOR_LOAD_TRAIL RGB565(0, 200, 255) 
+#define COLOR_MASK      RGB565(255, 128, 0)
+#define COLOR_HIST      RGB565(0, 200, 255)
 
 // --- 状态结构 ---
 typedef struct {
@@ -57,6 +88,12 @@ typedef struct {
     Uint32 start_press_time;
     int start_handled;
     int zero_pos_y;         
+    int tone_mode;          // 音调模式: 用声音播报信号频率
+    int proto_idx;          // 协议解码: 0 关闭, 其余为 PROTO_BAUDS 下标
+    int proto_scroll;       // 解码列表滚动行数 (0: 最新)
+    int mask_mode;          // 模板测试: 0 关闭, 1 测试, 2 测试且失败即暂停
+    int stats_view;         // 统计直方图: 0 关闭, 其余为 STAT_ 编号 + 1
+    int xy_mode;            // XY 显示: 信号对其自身延时副本打点
 } AppState;
 
 float VOLT_PER_DIV[] = {0.5f, 1.0f, 2.0f, 5.0f}; 
@@ -67,7 +104,27 @@ float TIME_PER_DIV[] = {0.5f, 1.0f, 2.0f, 5.0f, 10.0f, 20.0f, 50.0f, 100.0f, 200
 const char* TIME_DIV_STRS[] = {"500us", "1ms", "2ms", "5ms", "10ms", "20ms", "50ms", "100ms", "200ms", "500ms"};
 const int TIME_LEVELS = 10;
 
+// --- 长时间统计的测量量 ---
+enum { STAT_DX, STAT_DY, STAT_VPP, STAT_VAVG, STAT_FREQ, STAT_COUNT };
+const char* STAT_NAMES[] = {"dX (ms)", "dY (V)", "Vpp (V)", "Vavg (V)", "Freq (Hz)"};
+
+int PROTO_BAUDS[] = {0, 1200, 2400, 4800, 9600, 19200, 38400};
+const int PROTO_LEVELS = 7;
+
 int data_buffer[SCREEN_WIDTH]; 
+MeasureResult frame_measure;   // 最新一帧的自动测量结果
+int trace_top = 0, trace_bot = -1; // 本帧波形占用的行范围, 用于脏矩形
+ProtoDecoder uart_decoder;     // UART 解码器 (状态跨帧保留)
+MaskTest mask;                 // 模板测试包络与统计
+int frame_ys[SCREEN_WIDTH];    // 最近一帧换算后的屏幕 y (模板测试用)
+RunningStat run_stats[STAT_COUNT]; // 各测量量的长时间统计
+FeatureIndex features;         // 本帧的边沿与峰谷位置
+int features_dirty = 1;        // data_buffer 变化后索引尚未重建
+int frame_gap = 1;             // 上一帧之后有数据丢失 (暂停/丢帧/重同步), 新帧与旧帧不连续
+const char* FEATURE_NAMES[] = {"RISE", "FALL", "PEAK", "TROUGH"};
+XyPlot xy_plot;                // XY 模式的余辉缓冲与坐标查表
+char status_msg[16] = "";      // 状态栏临时提示
+Uint32 status_msg_time = 0;
 int serial_fd = -1;
 Uint32 last_packet_time = 0;   
 
@@ -78,7 +135,12 @@ AppState state = {
     CENTER_Y - 40, CENTER_Y + 40,
     0,
     0, 0, 0, 0,
-    CENTER_Y 
+    CENTER_Y,
+    0,
+    0, 0,
+    0,
+    0,
+    0
 };
 
 // --- 函数前向声明 ---
@@ -116,6 +178,15 @@ void draw_text_f(SDL_Surface* screen, int x, int y, Uint16 color, const char* fm
     draw_string(screen, x, y, buf, color);
 }
 
+// 在状态栏显示一条临时提示 (覆盖 RTT 位置, 最多 9 个字符)
+void show_status(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(status_msg, sizeof(status_msg), fmt, args);
+    va_end(args);
+    status_msg_time = SDL_GetTicks();
+}
+
 void draw_dotted_v(SDL_Surface* screen, int x, Uint16 color) {
     for (int y = 0; y < SCREEN_HEIGHT; y++) if (y % 4 < 2) put_pixel(screen, x, y, color);
 }
@@ -244,6 +315,143 @@ void draw_measurements(SDL_Surface* screen) {
     draw_text_f(screen, tx, ty+58, COLOR_TEXT, "dY: %.2fV", v2-v1);
 }
 
+// --- 模板测试 ---
+// 每 mV 的像素数 (16.16 定点), 与包络生成使用同一换算
+int32_t mask_scale_fp(void) {
+    return (int32_t)((float)GRID_SIZE / (VOLT_PER_DIV[state.volt_div_idx] * 1000.0f) * 65536.0f);
+}
+
+// 档位或零点变化后按黄金波形重建包络; 时基不同时返回 0 (暂停比较)
+int mask_ready(void) {
+    if (!mask.captured || mask.time_div_idx != state.time_div_idx) return 0;
+    if (mask.built_volt_idx != state.volt_div_idx || mask.built_zero_y != state.zero_pos_y) {
+        Mask_Build(&mask, mask_scale_fp(), state.zero_pos_y, state.volt_div_idx);
+    }
+    return 1;
+}
+
+void run_mask_test(void) {
+    if (!mask_ready()) return;
+    Mask_ToScreen(data_buffer, frame_ys, SCREEN_WIDTH, mask_scale_fp(), state.zero_pos_y);
+    if (Mask_Check(&mask, frame_ys, SCREEN_WIDTH) > 0 && state.mask_mode == 2) {
+        state.paused = 1;
+        show_status("MASK FAIL");
+    }
+}
+
+void draw_mask(SDL_Surface* screen) {
+    if (!state.mask_mode) return;
+    if (!mask_ready()) {
+        draw_string(screen, MASK_INFO_X, MASK_INFO_Y, "MASK: TIME/DIV", COLOR_MASK);
+        return;
+    }
+    if (SDL_MUSTLOCK(screen)) SDL_LockSurface(screen);
+    for (int x = 0; x < SCREEN_WIDTH; x += 2) {
+        put_pixel(screen, x, mask.lo[x], COLOR_MASK);
+        put_pixel(screen, x, mask.hi[x], COLOR_MASK);
+    }
+    // 越界列在波形上标红
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+        if (!mask.fail_col[x]) continue;
+        for (int k = -1; k <= 1; k++) put_pixel(screen, x, frame_ys[x] + k, COLOR_STATUS_NO);
+    }
+    if (SDL_MUSTLOCK(screen)) SDL_UnlockSurface(screen);
+
+    draw_text_f(screen, MASK_INFO_X, MASK_INFO_Y, mask.last_fail_cols ? COLOR_STATUS_NO : COLOR_STATUS_OK,
+                "%s P:%u F:%u", state.mask_mode == 2 ? "STOP" : "MASK", (unsigned)mask.passes, (unsigned)mask.fails);
+    draw_text_f(screen, MASK_INFO_X, MASK_INFO_Y + 9, COLOR_TEXT, "%uus max %uus",
+                (unsigned)mask.last_us, (unsigned)mask.max_us);
+}
+
+// --- 长时间统计 ---
+void update_stats(void) {
+    Stats_Add(&run_stats[STAT_DX], pixel_to_time(state.cursor_x2) - pixel_to_time(state.cursor_x1));
+    Stats_Add(&run_stats[STAT_DY], pixel_to_volt(state.cursor_y2) - pixel_to_volt(state.cursor_y1));
+    Stats_Add(&run_stats[STAT_VPP], (frame_measure.max_mv - frame_measure.min_mv) / 1000.0f);
+    Stats_Add(&run_stats[STAT_VAVG], frame_measure.mean_mv / 1000.0f);
+    if (frame_measure.freq_hz > 0.0f) Stats_Add(&run_stats[STAT_FREQ], frame_measure.freq_hz);
+}
+
+// 按当前档位的整屏范围确定直方图初始桶宽; 复位后量程也能随档位缩小
+void reset_stats(void) {
+    float screen_v = VOLT_PER_DIV[state.volt_div_idx] * SCREEN_HEIGHT / GRID_SIZE;
+    Stats_Reset(&run_stats[STAT_DX], TIME_PER_DIV[state.time_div_idx] * SCREEN_WIDTH / GRID_SIZE);
+    Stats_Reset(&run_stats[STAT_DY], screen_v);
+    Stats_Reset(&run_stats[STAT_VPP], screen_v);
+    Stats_Reset(&run_stats[STAT_VAVG], screen_v);
+    Stats_Reset(&run_stats[STAT_FREQ], 0.0f); // 频率没有按屏幕的自然范围
+}
+
+void draw_stats_view(SDL_Surface* screen) {
+    if (!state.stats_view) return;
+    const RunningStat* st = &run_stats[state.stats_view - 1];
+
+    SDL_Rect win = {STATS_WIN_X, STATS_WIN_Y, STATS_WIN_W, STATS_WIN_H};
+    SDL_FillRect(screen, &win, COLOR_OVERLAY);
+    int tx = STATS_WIN_X + 5, ty = STATS_WIN_Y + 4;
+    draw_text_f(screen, tx, ty, COLOR_CURSOR, "%s  n=%u", STAT_NAMES[state.stats_view - 1], (unsigned)st->count);
+    if (st->count == 0) {
+        draw_string(screen, tx, ty + 12, "NO DATA", COLOR_TEXT);
+        return;
+    }
+    draw_text_f(screen, tx, ty + 10, COLOR_TEXT, "mean %.4g  sd %.3g", st->mean, Stats_Stddev(st));
+    draw_text_f(screen, tx, ty + 20, COLOR_TEXT, "min %.4g  max %.4g", st->min, st->max);
+
+    // 直方图
+    Uint32 peak = 1;
+    for (int i = 0; i < STATS_BUCKETS; i++) if (st->hist[i] > peak) peak = st->hist[i];
+    int base_y = STATS_WIN_Y + STATS_WIN_H - 16;
+    int bx = STATS_WIN_X + (STATS_WIN_W - STATS_BUCKETS * STATS_BAR_W) / 2;
+    for (int i = 0; i < STATS_BUCKETS; i++) {
+        int h = (int)((Uint64)st->hist[i] * STATS_BAR_H / peak);
+        if (st->hist[i] && h == 0) h = 1;
+        SDL_Rect bar = {bx + i * STATS_BAR_W, base_y - h, STATS_BAR_W - 1, h};
+        SDL_FillRect(screen, &bar, COLOR_HIST);
+    }
+    draw_text_f(screen, bx, base_y + 4, COLOR_TEXT, "%.4g", st->h_lo);
+    char hi_txt[16];
+    snprintf(hi_txt, sizeof(hi_txt), "%.4g", st->h_lo + STATS_BUCKETS * st->h_width);
+    draw_string(screen, bx + STATS_BUCKETS * STATS_BAR_W - (int)strlen(hi_txt) * 6, base_y + 4, hi_txt, COLOR_TEXT);
+}
+
+// --- 协议解码显示 ---
+// 只读取解码器已有的结果, 重绘不触发解码
+void draw_proto(SDL_Surface* screen) {
+    if (!state.proto_idx) return;
+    float pixels_per_mv = (float)GRID_SIZE / (VOLT_PER_DIV[state.volt_div_idx] * 1000.0f);
+
+    // 1. 本帧解出的字节标注在波形上方; 屏幕上没有波形 (波形带为空) 时不标注
+    uint32_t cur_frame = uart_decoder.frame_no - 1;
+    if (trace_bot >= trace_top) for (uint32_t i = 0; ; i++) {
+        const ProtoByte* b = Proto_Get(&uart_decoder, i);
+        if (!b || b->frame_no != cur_frame) break;
+        if (b->x < 0 || b->x >= SCREEN_WIDTH) continue;
+        int y = state.zero_pos_y - (int)(data_buffer[b->x] * pixels_per_mv) - PROTO_TAG_GAP;
+        // 限制在 report_dirty 跟踪的波形带内 (波形上方 PROTO_TAG_GAP 到波形底部), 否则留下残影;
+        // 波形贴近顶部时标签会被屏幕上沿裁掉一部分
+        if (y > trace_bot - 7) y = trace_bot - 7;
+        if (y < trace_top - PROTO_TAG_GAP) y = trace_top - PROTO_TAG_GAP;
+        char tag[4];
+        snprintf(tag, sizeof(tag), "%02X", b->value);
+        draw_cursor_tag(screen, b->x, y, tag, COLOR_BAR_BG, b->framing_error ? COLOR_STATUS_NO : COLOR_TEXT);
+    }
+
+    // 2. 左下角解码列表
+    SDL_Rect panel = {PROTO_PANEL_X, PROTO_PANEL_Y, PROTO_PANEL_W, PROTO_PANEL_H};
+    SDL_FillRect(screen, &panel, COLOR_OVERLAY);
+    int tx = PROTO_PANEL_X + 3, ty = PROTO_PANEL_Y + 2;
+    if (uart_decoder.undersampled) draw_string(screen, tx, ty, "UART:SLOW TB", COLOR_STATUS_NO);
+    else draw_text_f(screen, tx, ty, COLOR_CURSOR, "UART %d", uart_decoder.baud);
+    for (int line = 0; line < PROTO_PANEL_LINES; line++) {
+        uint32_t idx = state.proto_scroll + line;
+        const ProtoByte* b = Proto_Get(&uart_decoder, idx);
+        if (!b) break;
+        char c = (b->value >= 32 && b->value <= 122) ? (char)b->value : '.';
+        draw_text_f(screen, tx, ty + 8 * (line + 1), b->framing_error ? COLOR_STATUS_NO : COLOR_TEXT,
+                    "%4u %02X %c", (unsigned)((uart_decoder.log_count - 1 - idx) % 10000), b->value, c);
+    }
+}
+
 void draw_exit_dialog(SDL_Surface* screen) {
     if (!state.show_exit_dialog) return;
     SDL_Rect rect = {CENTER_X - 80, CENTER_Y - 30, 160, 60};
@@ -258,22 +466,37 @@ void draw_ui(SDL_Surface* screen, int connected) {
     if (SDL_MUSTLOCK(screen)) SDL_LockSurface(screen);
     float mv_per_div = VOLT_PER_DIV[state.volt_div_idx] * 1000.0f;
     float pixels_per_mv = (float)GRID_SIZE / mv_per_div;
-    for (int x = 0; x < SCREEN_WIDTH - 1; x++) {
-        int mv_val = data_buffer[x];
-        int mv_next = data_buffer[x+1];
-        int scaled_y = state.zero_pos_y - (int)(mv_val * pixels_per_mv);
-        int scaled_next = state.zero_pos_y - (int)(mv_next * pixels_per_mv);
-        if (scaled_y >= 0 && scaled_y < SCREEN_HEIGHT) {
-            put_pixel(screen, x, scaled_y, COLOR_WAVE);
-            if (abs(scaled_next - scaled_y) > 1 && abs(scaled_next - scaled_y) < SCREEN_HEIGHT) {
-                int step = (scaled_next > scaled_y) ? 1 : -1;
-                for (int k = scaled_y; k != scaled_next; k += step) if (k>=0 && k<SCREEN_HEIGHT) put_pixel(screen, x, k, COLOR_WAVE);
+    trace_top = SCREEN_HEIGHT; trace_bot = -1;
+    if (state.xy_mode) {
+        // XY 模式: 画累积的余辉代替时间轴波形, 亮点所在行作为脏矩形范围
+        Xy_Render(&xy_plot, (Uint16*)screen->pixels, screen->pitch / 2, &trace_top, &trace_bot);
+    } else {
+        for (int x = 0; x < SCREEN_WIDTH - 1; x++) {
+            int mv_val = data_buffer[x];
+            int mv_next = data_buffer[x+1];
+            int scaled_y = state.zero_pos_y - (int)(mv_val * pixels_per_mv);
+            int scaled_next = state.zero_pos_y - (int)(mv_next * pixels_per_mv);
+            if (scaled_y >= 0 && scaled_y < SCREEN_HEIGHT) {
+                put_pixel(screen, x, scaled_y, COLOR_WAVE);
+                if (scaled_y < trace_top) trace_top = scaled_y;
+                if (scaled_y > trace_bot) trace_bot = scaled_y;
+                if (abs(scaled_next - scaled_y) > 1 && abs(scaled_next - scaled_y) < SCREEN_HEIGHT) {
+                    if (scaled_next < trace_top) trace_top = scaled_next;
+                    if (scaled_next > trace_bot) trace_bot = scaled_next;
+                    int step = (scaled_next > scaled_y) ? 1 : -1;
+                    for (int k = scaled_y; k != scaled_next; k += step) if (k>=0 && k<SCREEN_HEIGHT) put_pixel(screen, x, k, COLOR_WAVE);
+                }
             }
         }
     }
     if (SDL_MUSTLOCK(screen)) SDL_UnlockSurface(screen);
     
+    if (!state.xy_mode) {
+        draw_mask(screen);
+        draw_proto(screen);
+    }
     draw_measurements(screen);
+    draw_stats_view(screen);
     
     if (state.show_measure) {
         Pusher_Render(screen);
@@ -286,31 +509,438 @@ void draw_ui(SDL_Surface* screen, int connected) {
     SDL_Rect stat = {5, SCREEN_HEIGHT - 14, 8, 8}; SDL_FillRect(screen, &stat, stat_color);
     draw_text_f(screen, 20, SCREEN_HEIGHT - 13, COLOR_TEXT, "Time:%s", TIME_DIV_STRS[state.time_div_idx]);
     draw_text_f(screen, 100, SCREEN_HEIGHT - 13, COLOR_TEXT, "Volt:%s", VOLT_DIV_STRS[state.volt_div_idx]);
+    CmdStats cmd_stats;
+    Cmd_GetStats(&cmd_stats);
+    if (status_msg[0] && SDL_GetTicks() - status_msg_time < STATUS_MSG_MS) draw_string(screen, 160, SCREEN_HEIGHT - 13, status_msg, COLOR_STATUS_PAUSE);
+    else if (cmd_stats.acked > 0) draw_text_f(screen, 160, SCREEN_HEIGHT - 13, COLOR_TEXT, "RTT:%ums", (unsigned)cmd_stats.last_rtt);
+    else draw_string(screen, 160, SCREEN_HEIGHT - 13, "RTT:--", COLOR_TEXT);
     draw_text_f(screen, 220, SCREEN_HEIGHT - 13, COLOR_TEXT, state.show_measure ? "[MEASURE]" : "[VIEW]");
 }
 
+// --- 脏区域上报 ---
+// 界面由状态决定, 状态不变时两帧之间只有波形带和状态栏会变化
+void report_dirty(int connected) {
+    static AppState last_state;
+    static int last_connected = -1;
+    static int last_pusher = -1;
+    static int last_top = 0, last_bot = -1;
+
+    int pusher = state.show_measure && Pusher_IsVisible();
+    if (last_connected < 0 || connected != last_connected || pusher != last_pusher || pusher ||
+        memcmp(&state, &last_state, sizeof(state)) != 0) {
+        Display_MarkDirty(NULL);
+    } else {
+        int top = (trace_top < last_top) ? trace_top : last_top;
+        int bot = (trace_bot > last_bot) ? trace_bot : last_bot;
+        if (state.stats_view) {
+            SDL_Rect win = {STATS_WIN_X, STATS_WIN_Y, STATS_WIN_W, STATS_WIN_H};
+            Display_MarkDirty(&win);
+        }
+        if (state.mask_mode) {
+            // 越界标红比波形上下各宽 1 像素, 计数随帧变化
+            top -= 1;
+            bot += 1;
+            SDL_Rect info = {MASK_INFO_X, MASK_INFO_Y, MASK_INFO_W, MASK_INFO_H};
+            Display_MarkDirty(&info);
+        }
+        if (state.proto_idx) {
+            // 解码标注画在波形上方, 列表内容随帧变化
+            top -= PROTO_TAG_GAP;
+            SDL_Rect panel = {PROTO_PANEL_X, PROTO_PANEL_Y, PROTO_PANEL_W, PROTO_PANEL_H};
+            Display_MarkDirty(&panel);
+        }
+        if (bot >= top) {
+            SDL_Rect band = {0, top, SCREEN_WIDTH, bot - top + 1};
+            Display_MarkDirty(&band);
+        }
+        SDL_Rect bar = {0, SCREEN_HEIGHT - 20, SCREEN_WIDTH, 20};
+        Display_MarkDirty(&bar);
+    }
+
+    last_state = state;
+    last_connected = connected;
+    last_pusher = pusher;
+    last_top = trace_top;
+    last_bot = trace_bot;
+}
+
+// 投递到命令队列, 由主循环中的 Cmd_Poll 非阻塞发出; 应答到达前的旧时基帧会被丢弃
 void send_timebase_command(int idx) {
     if (serial_fd == -1) return;
-    char cmd_buf[32];
-    int len = snprintf(cmd_buf, sizeof(cmd_buf), "TIM:%d\n", idx);
-    if (write(serial_fd, cmd_buf, len) != len) {
-    }
+    Cmd_Post(CMD_TIMEBASE, idx);
     for (int i = 0; i < SCREEN_WIDTH; i++) data_buffer[i] = 0;
+    features_dirty = 1;
+}
+
+FrameParser rx_parser;
+int frame_samples[FRAME_POINTS];
+
+// --- 音调模式 ---
+#define TONE_MIN_HZ 200.0f
+#define TONE_MAX_HZ 2000.0f
+
+// 把信号频率按倍频程折叠到可听范围, 音高随信号频率变化
+float tone_freq_for(float signal_hz) {
+    if (signal_hz <= 0.0f) return 0.0f;
+    while (signal_hz < TONE_MIN_HZ) signal_hz *= 2.0f;
+    while (signal_hz > TONE_MAX_HZ) signal_hz *= 0.5f;
+    return signal_hz;
+}
+
+// --- XY 显示 ---
+// 只有一路通道, 以信号本身为 X、延时 1/4 周期的副本为 Y (正弦即画圆);
+// 两轴共用 volt/div, zero_pos_y 同时平移两轴, 让居中的信号在 XY 图上也居中
+#define XY_DEFAULT_DELAY 8 // 周期未知时的延时 (采样点)
+
+void update_xy(void) {
+    Xy_SetScale(&xy_plot, mask_scale_fp(), CENTER_X + CENTER_Y - state.zero_pos_y, state.zero_pos_y);
+    int delay = XY_DEFAULT_DELAY;
+    float ms_per_sample = TIME_PER_DIV[state.time_div_idx] / (float)GRID_SIZE;
+    if (frame_measure.period_ms > 0.0f) {
+        int quarter = (int)(frame_measure.period_ms / ms_per_sample / 4.0f + 0.5f);
+        if (quarter >= 1 && quarter < SCREEN_WIDTH / 2) delay = quarter;
+    }
+    // X 取 t 时刻, Y 取 t - delay 时刻
+    Xy_Accumulate(&xy_plot, data_buffer + delay, data_buffer, SCREEN_WIDTH - delay);
+}
+
+// --- 光标吸附 ---
+// 迟滞门限与 Measure_Frame 一致, 直接用本帧的测量结果, 只需扫描一遍
+void update_features(void) {
+    if (!features_dirty) return;
+    int lo, hi;
+    Measure_Band(&frame_measure, &lo, &hi);
+    Feature_Build(&features, data_buffer, SCREEN_WIDTH, lo, hi);
+    features_dirty = 0;
+}
+
+// X 光标下一个 (dir > 0) 或上一个特征的位置; -1 表示没有可跳的特征
+int snap_x_target(int x, int dir) {
+    update_features();
+    int i = (dir > 0) ? Feature_Next(&features, x) : Feature_Prev(&features, x);
+    if (i < 0) return -1;
+    show_status("%s", FEATURE_NAMES[features.kind[i]]);
+    return features.pos[i];
+}
+
+// Y 光标吸附到某条 X 光标处的波形值; -1 表示 X 光标在屏幕外
+int snap_y_target(int at_x) {
+    if (at_x < 0 || at_x >= SCREEN_WIDTH) return -1;
+    float pixels_per_mv = (float)GRID_SIZE / (VOLT_PER_DIV[state.volt_div_idx] * 1000.0f);
+    int ty = state.zero_pos_y - (int)(data_buffer[at_x] * pixels_per_mv);
+    if (ty < 0) ty = 0;
+    if (ty >= SCREEN_HEIGHT) ty = SCREEN_HEIGHT - 1;
+    return ty;
+}
+
+// 吸附不直接瞬移: 每轮主循环最多走 SNAP_STEP_PX, 小人按每步的位移推着光标过去
+#define SNAP_STEP_PX 8
+
+typedef struct {
+    int* cursor;     // 正在移动的光标, NULL 表示没有进行中的吸附
+    CursorType type;
+    int target;
+} SnapAnim;
+
+SnapAnim snap_anim;
+
+void snap_start(int* cursor, CursorType type, int target) {
+    snap_anim.cursor = (target != *cursor) ? cursor : NULL;
+    snap_anim.type = type;
+    snap_anim.target = target;
+}
+
+void snap_poll(void) {
+    if (!snap_anim.cursor) return;
+    int delta = snap_anim.target - *snap_anim.cursor;
+    if (delta > SNAP_STEP_PX) delta = SNAP_STEP_PX;
+    if (delta < -SNAP_STEP_PX) delta = -SNAP_STEP_PX;
+    *snap_anim.cursor += delta;
+    Pusher_OnMove(snap_anim.type, *snap_anim.cursor, delta);
+    if (*snap_anim.cursor == snap_anim.target) snap_anim.cursor = NULL;
+}
+
+// --- 自动设置 (Auto-set) ---
+// 每帧只扫描一遍 (极值/均值/上升沿在同一个循环里), 一步跳到目标时基而不是逐档试探;
+// 时基变化后由 Cmd_FramesValid 丢弃旧比例的帧, 下一帧有效数据再复核一次
+#define AUTOSET_FILL_DIVS  6     // 峰峰值最多占用的垂直格数 (屏幕共 8 格)
+#define AUTOSET_PERIODS    2.5f  // 一屏至少显示的周期数
+#define AUTOSET_MIN_VPP_MV 50    // 低于此峰峰值视为直流, 不再调整时基
+#define AUTOSET_MAX_STEPS  4     // 时基最多切换次数, 防止信号不稳时来回跳
+#define AUTOSET_WAIT_MS    500   // 在一帧的采集时长之外, 最多再等这么久的有效帧
+
+typedef struct {
+    int active;
+    int steps;          // 已切换时基的次数
+    Uint32 start_time;
+    Uint32 step_time;   // 开始或最近一次切换时基的时间, 超时判定从这里算
+    int thr_lo, thr_hi; // 上升沿检测的迟滞门限, 取自上一帧
+} AutoSet;
+
+AutoSet autoset;
+
+void autoset_start(void) {
+    if (serial_fd == -1) { show_status("NO SIGNAL"); return; }
+    state.paused = 0;
+    autoset.active = 1;
+    autoset.steps = 0;
+    autoset.start_time = autoset.step_time = SDL_GetTicks();
+    Measure_Band(&frame_measure, &autoset.thr_lo, &autoset.thr_hi);
+    show_status("AUTO...");
+}
+
+void autoset_finish(const char* result) {
+    Uint32 ms = SDL_GetTicks() - autoset.start_time;
+    autoset.active = 0;
+    printf("Autoset: %s after %u ms, %d timebase steps\n", result, (unsigned)ms, autoset.steps);
+    show_status("%s %ums", result, (unsigned)ms);
+}
+
+// 单遍扫描. 沿检测的门限来自上一帧 (按键前最后一帧或上一次扫描);
+// 门限落在本帧幅度之外时沿计数不可信, 返回 0, 门限已按本帧更新, 等下一帧
+int autoset_scan(const int* samples, int n, float ms_per_sample, MeasureResult* out) {
+    int lo = autoset.thr_lo, hi = autoset.thr_hi;
+    Measure_FrameWithThreshold(samples, n, ms_per_sample, lo, hi, out);
+    Measure_Band(out, &autoset.thr_lo, &autoset.thr_hi);
+    return hi > lo && lo > out->min_mv && hi < out->max_mv;
+}
+
+// 选取能容纳峰峰值的最小伏/格, 并把信号中点移到屏幕中央
+void autoset_vertical(const MeasureResult* m) {
+    int vpp = m->max_mv - m->min_mv;
+    int idx = VOLT_LEVELS - 1;
+    for (int i = 0; i < VOLT_LEVELS; i++) {
+        if (vpp <= (int)(VOLT_PER_DIV[i] * 1000.0f) * AUTOSET_FILL_DIVS) { idx = i; break; }
+    }
+    state.volt_div_idx = idx;
+    float mid_mv = (m->max_mv + m->min_mv) * 0.5f;
+    state.zero_pos_y = CENTER_Y + (int)(mid_mv * GRID_SIZE / (VOLT_PER_DIV[idx] * 1000.0f));
+}
+
+// 返回目标时基下标; 周期未知时按上升沿个数估计需要放大的档数
+int autoset_timebase(const MeasureResult* m) {
+    int cur = state.time_div_idx;
+    if (m->max_mv - m->min_mv < AUTOSET_MIN_VPP_MV) return cur;
+    if (m->period_ms <= 0.0f) {
+        int jump = (m->rising_edges == 1) ? 2 : 3; // 一屏不足一个周期
+        return (cur + jump < TIME_LEVELS) ? cur + jump : TIME_LEVELS - 1;
+    }
+    float need_ms = m->period_ms * AUTOSET_PERIODS * GRID_SIZE / (float)SCREEN_WIDTH;
+    for (int i = 0; i < TIME_LEVELS; i++) {
+        if (TIME_PER_DIV[i] >= need_ms) return i;
+    }
+    return TIME_LEVELS - 1;
 }
 
-#define FRAME_HEADER_SIZE 2
-#define DATA_POINTS       SCREEN_WIDTH
-#define FRAME_DATA_SIZE   (DATA_POINTS * 2)
-#define FRAME_SIZE        (FRAME_HEADER_SIZE + FRAME_DATA_SIZE)
+void autoset_step(float ms_per_sample) {
+    MeasureResult m;
+    int edges_valid = autoset_scan(data_buffer, SCREEN_WIDTH, ms_per_sample, &m);
+    autoset_vertical(&m);
+    if (!edges_valid && m.max_mv - m.min_mv >= AUTOSET_MIN_VPP_MV) return;
 
-uint8_t rx_buffer[FRAME_SIZE * 2]; 
-int rx_len = 0;
+    int target = autoset_timebase(&m);
+    if (target != state.time_div_idx && autoset.steps < AUTOSET_MAX_STEPS) {
+        autoset.steps++;
+        autoset.step_time = SDL_GetTicks();
+        state.time_div_idx = target;
+        send_timebase_command(target);
+        return;
+    }
+    autoset_finish("LOCK");
+}
+
+// 主循环每轮调用: 等不到有效帧 (断线、门限一直不对) 时放弃, 不让自动设置一直占着帧处理
+void autoset_poll(void) {
+    if (!autoset.active) return;
+    Uint32 frame_ms = (Uint32)(TIME_PER_DIV[state.time_div_idx] * SCREEN_WIDTH / GRID_SIZE);
+    if (SDL_GetTicks() - autoset.step_time > AUTOSET_WAIT_MS + frame_ms) autoset_finish("NO LOCK");
+}
+
+// 每收到一帧有效数据调用一次 (不在每次重绘时调用)
+void on_new_frame(void) {
+    float ms_per_sample = TIME_PER_DIV[state.time_div_idx] / (float)GRID_SIZE;
+    if (autoset.active) {
+        autoset_step(ms_per_sample);
+        if (autoset.active) {
+            // 仍在调整, 本帧不再参与后续处理; 解码器没见到这一帧, 下一帧不能当作连续数据
+            frame_gap = 1;
+            return;
+        }
+    }
+    Measure_Frame(data_buffer, SCREEN_WIDTH, ms_per_sample, &frame_measure);
+    if (state.tone_mode) Audio_SetTone(tone_freq_for(frame_measure.freq_hz));
+    update_stats();
+    if (state.mask_mode) run_mask_test();
+    // 测量模式下随帧重建特征索引, 其余时候只做标记, 需要时再建
+    features_dirty = 1;
+    if (state.show_measure) update_features();
+    if (state.xy_mode) update_xy();
+    if (state.proto_idx) {
+        if (frame_gap) Proto_Gap(&uart_decoder);
+        Proto_Feed(&uart_decoder, data_buffer, SCREEN_WIDTH, ms_per_sample * 1000.0f);
+    }
+    frame_gap = 0;
+
+    static uint32_t frame_seq = 0;
+    StreamMeta meta = {
+        frame_seq++, SDL_GetTicks(),
+        state.time_div_idx, state.volt_div_idx,
+        frame_measure.min_mv, frame_measure.max_mv, frame_measure.mean_mv,
+        frame_measure.freq_hz
+    };
+    Stream_Publish(data_buffer, SCREEN_WIDTH, &meta);
+}
+
+// --- START 组合键 (按住 START 再按其它键) ---
+// 触发后 START 松开时不再切换暂停
+void handle_function_key(SDL_Surface* screen, int key) {
+    if (key == SDLK_LSHIFT) {
+        // X 键 (LSHIFT): 音调模式
+        state.tone_mode = !state.tone_mode;
+        Audio_SetTone(state.tone_mode ? tone_freq_for(frame_measure.freq_hz) : 0.0f);
+    }
+    else if (key == SDLK_LALT) {
+        // 统计直方图: 关闭 -> 逐个测量量 -> 关闭
+        state.stats_view = (state.stats_view + 1) % (STAT_COUNT + 1);
+    }
+    else if (key == SDLK_SPACE) {
+        autoset_start();
+    }
+    else if (key == SDLK_UP) {
+        state.xy_mode = !state.xy_mode;
+        Xy_Clear(&xy_plot);
+        show_status(state.xy_mode ? "XY ON" : "XY OFF");
+    }
+    else if (key == SDLK_LCTRL) {
+        reset_stats();
+        show_status("STATS CLR");
+    }
+    else if (key == SDLK_BACKSPACE) {
+        // 模板测试: 关闭 -> 以当前帧为黄金波形开始测试 -> 失败即暂停 -> 关闭
+        state.mask_mode = (state.mask_mode + 1) % 3;
+        if (state.mask_mode == 1) {
+            Mask_Capture(&mask, data_buffer, SCREEN_WIDTH, state.time_div_idx);
+            show_status("MASK SET");
+        }
+        else if (state.mask_mode == 2) show_status("STOP FAIL");
+        else show_status("MASK OFF");
+    }
+    else if (key == SDLK_TAB) {
+        // 协议解码: 关闭 -> 各波特率循环
+        state.proto_idx = (state.proto_idx + 1) % PROTO_LEVELS;
+        state.proto_scroll = 0;
+        Proto_Init(&uart_decoder, state.proto_idx ? PROTO_UART : PROTO_OFF, PROTO_BAUDS[state.proto_idx]);
+    }
+    else if (key == SDLK_ESCAPE) {
+        // 截图: 拷贝当前画面与采样后立即返回, 写卡在后台线程
+        SnapshotMeta meta = {
+            TIME_PER_DIV[state.time_div_idx] / (float)GRID_SIZE,
+            TIME_DIV_STRS[state.time_div_idx], VOLT_DIV_STRS[state.volt_div_idx]
+        };
+        if (Snapshot_Request(screen, data_buffer, SCREEN_WIDTH, &meta) != 0) show_status("SNAP FULL");
+        else show_status("SNAP...");
+    }
+}
+
+// --- PGO 训练脚本 ---
+// SCOPE_TRAIN_MODES=1 时 (需同时设置 SCOPE_BENCH_LOOPS), 运行均分成若干段, 在主循环的事件队列前
+// 注入按键: 每段打开一种模式并在段内操作, 段尾恢复默认界面. 按键走与真实输入相同的处理路径,
+// profile 因此覆盖测量/吸附、模板测试、解码、XY、统计、音调和自动设置的热循环, 不会被当作冷代码
+#define TRAIN_START      0x10000 // 与 START 组合按下
+#define TRAIN_KEY_EVERY  8       // 段内每隔多少轮按下一个操作键
+#define TRAIN_MAX_KEYS   12
+
+typedef struct {
+    int enter[TRAIN_MAX_KEYS]; // 段开头依次按下, 以 0 结束
+    int during[TRAIN_MAX_KEYS];// 段内循环按下
+    int leave[TRAIN_MAX_KEYS]; // 段结尾依次按下, 回到默认界面
+} TrainPhase;
+
+static const TrainPhase TRAIN_PHASES[] = {
+    // 默认界面
+    {{0}, {0}, {0}},
+    // 测量: 移动/吸附四条光标
+    {{SDLK_ESCAPE},
+     {SDLK_RIGHT, SDLK_PAGEDOWN, SDLK_TAB, SDLK_LEFT, SDLK_PAGEUP, SDLK_TAB,
+      SDLK_DOWN, SDLK_PAGEDOWN, SDLK_TAB, SDLK_UP, SDLK_PAGEUP, SDLK_TAB},
+     {SDLK_ESCAPE}},
+    // 模板测试 (只测试不暂停), 关闭时经过一次 "失败即暂停" 档
+    {{TRAIN_START | SDLK_BACKSPACE}, {0}, {TRAIN_START | SDLK_BACKSPACE, TRAIN_START | SDLK_BACKSPACE}},
+    // UART 9600 解码并滚动列表
+    {{TRAIN_START | SDLK_TAB, TRAIN_START | SDLK_TAB, TRAIN_START | SDLK_TAB, TRAIN_START | SDLK_TAB},
+     {SDLK_PAGEUP, SDLK_PAGEUP, SDLK_PAGEDOWN, SDLK_PAGEDOWN},
+     {TRAIN_START | SDLK_TAB, TRAIN_START | SDLK_TAB, TRAIN_START | SDLK_TAB}},
+    // XY
+    {{TRAIN_START | SDLK_UP}, {0}, {TRAIN_START | SDLK_UP}},
+    // 统计直方图
+    {{TRAIN_START | SDLK_LALT}, {0},
+     {TRAIN_START | SDLK_LALT, TRAIN_START | SDLK_LALT, TRAIN_START | SDLK_LALT,
+      TRAIN_START | SDLK_LALT, TRAIN_START | SDLK_LALT}},
+    // 音调
+    {{TRAIN_START | SDLK_LSHIFT}, {0}, {TRAIN_START | SDLK_LSHIFT}},
+    // 自动设置: 段内先换几档时基再触发, 从不同起点收敛
+    {{TRAIN_START | SDLK_SPACE}, {SDLK_LCTRL, SDLK_LCTRL, SDLK_LCTRL, TRAIN_START | SDLK_SPACE}, {0}},
+};
+#define TRAIN_PHASE_COUNT ((int)(sizeof(TRAIN_PHASES) / sizeof(TRAIN_PHASES[0])))
+
+#define TRAIN_QUEUE_SIZE 128
+SDL_Event train_queue[TRAIN_QUEUE_SIZE];
+int train_head = 0, train_tail = 0;
+
+void train_push_event(Uint8 type, int key) {
+    if (train_tail >= TRAIN_QUEUE_SIZE) return;
+    SDL_Event* e = &train_queue[train_tail++];
+    memset(e, 0, sizeof(*e));
+    e->type = type;
+    e->key.type = type;
+    e->key.state = (type == SDL_KEYDOWN) ? SDL_PRESSED : SDL_RELEASED;
+    e->key.keysym.sym = (SDLKey)key;
+}
+
+void train_press(int key) {
+    int sym = key & ~TRAIN_START;
+    if (key & TRAIN_START) train_push_event(SDL_KEYDOWN, SDLK_RETURN);
+    train_push_event(SDL_KEYDOWN, sym);
+    train_push_event(SDL_KEYUP, sym);
+    if (key & TRAIN_START) train_push_event(SDL_KEYUP, SDLK_RETURN);
+}
+
+void train_press_all(const int* keys) {
+    for (int i = 0; i < TRAIN_MAX_KEYS && keys[i]; i++) train_press(keys[i]);
+}
+
+// 每轮主循环开头调用, 按进度排入本轮的按键
+void train_script(int loop, int total) {
+    train_head = train_tail = 0;
+    int len = total / TRAIN_PHASE_COUNT;
+    if (len <= 0) return;
+    int phase = loop / len, pos = loop % len;
+    if (phase >= TRAIN_PHASE_COUNT) return;
+    const TrainPhase* ph = &TRAIN_PHASES[phase];
+    if (pos == 0) {
+        if (phase > 0) train_press_all(TRAIN_PHASES[phase - 1].leave);
+        train_press_all(ph->enter);
+    } else if (pos % TRAIN_KEY_EVERY == 0 && ph->during[0]) {
+        int n = 0;
+        while (n < TRAIN_MAX_KEYS && ph->during[n]) n++;
+        train_press(ph->during[(pos / TRAIN_KEY_EVERY) % n]);
+    }
+}
+
+// 先取脚本注入的按键, 再取真实事件
+int poll_event(SDL_Event* event) {
+    if (train_head < train_tail) {
+        *event = train_queue[train_head++];
+        return 1;
+    }
+    return SDL_PollEvent(event);
+}
 
 int main(int argc, char* argv[]) {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) return 1;
     SDL_ShowCursor(SDL_DISABLE); 
     SDL_EnableKeyRepeat(300, 30);
-    SDL_Surface* screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 16, SDL_SWSURFACE);
+    SDL_Surface* screen = Display_Open(SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 16, SDL_SWSURFACE));
     
     if (Audio_Init("key_sound.wav") != 0) {
         printf("Warning: Audio init failed. Ensure key_sound.wav exists.\n");
@@ -320,6 +950,38 @@ int main(int argc, char* argv[]) {
         printf("Pusher Init Failed (check walk.bmp)\n");
     }
 
+    if (Stream_Init() != 0) {
+        printf("Warning: stream server failed to start.\n");
+    }
+
+    Xy_Init(&xy_plot, 0, 255, 0);
+    reset_stats();
+
+    if (Snapshot_Init() != 0) {
+        printf("Warning: snapshot thread failed to start.\n");
+    }
+    int last_snap_saved = 0, last_snap_failed = 0;
+
+    // 录制串口原始数据, 供离线分析工具 (make analyzer) 使用
+    FILE* record_fp = NULL;
+    const char* record_path = getenv("SCOPE_RECORD");
+    if (record_path && *record_path) {
+        record_fp = fopen(record_path, "ab");
+        if (!record_fp) printf("Warning: cannot open record file %s\n", record_path);
+    }
+
+    // 无设备运行: SCOPE_SERIAL 可指向录制文件或 "synth" (见 serial_hal.h)
+    const char* serial_port = getenv("SCOPE_SERIAL");
+    if (!serial_port || !*serial_port) serial_port = SERIAL_PORT;
+
+    // 基准/训练模式: 跑满 SCOPE_BENCH_LOOPS 轮主循环后退出, 不做帧间延时, 退出时打印平均耗时
+    const char* bench_str = getenv("SCOPE_BENCH_LOOPS");
+    int bench_loops = bench_str ? atoi(bench_str) : 0;
+    int loop_count = 0, bench_frames = 0;
+    uint32_t bench_start = Time_NowUs();
+    const char* train_str = getenv("SCOPE_TRAIN_MODES");
+    int train_modes = bench_loops > 0 && train_str && atoi(train_str) > 0;
+
     int running = 1;
     for (int i = 0; i < SCREEN_WIDTH; i++) data_buffer[i] = 0;
 
@@ -328,7 +990,8 @@ int main(int argc, char* argv[]) {
 
     while (running) {
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
+        if (train_modes) train_script(loop_count, bench_loops);
+        while (poll_event(&event)) {
             if (event.type == SDL_QUIT) running = 0;
             
             if (event.type == SDL_KEYDOWN) {
@@ -363,6 +1026,11 @@ int main(int argc, char* argv[]) {
                         state.start_handled = 0;
                     }
                 }
+                if (state.start_pressed && key != SDLK_RETURN) {
+                    state.start_handled = 1;
+                    handle_function_key(screen, key);
+                    continue;
+                }
                 if (key == SDLK_ESCAPE) state.show_measure = !state.show_measure;
 
                 if (key == SDLK_LCTRL) { 
@@ -404,11 +1072,26 @@ int main(int argc, char* argv[]) {
                         *target += step; moved = 1; move_delta = step;
                     }
                     
+                    // L2/R2: X 光标跳到上一个/下一个边沿或峰谷; Y 光标吸附到 X1/X2 处的波形
+                    if (key == SDLK_PAGEUP || key == SDLK_PAGEDOWN) {
+                        int to;
+                        if (state.active_cursor < 2) to = snap_x_target(*target, key == SDLK_PAGEDOWN ? 1 : -1);
+                        else to = snap_y_target(key == SDLK_PAGEUP ? state.cursor_x1 : state.cursor_x2);
+                        if (to >= 0) snap_start(target, move_type, to);
+                    }
+
                     if (moved) {
+                        snap_anim.cursor = NULL; // 手动移动打断进行中的吸附
                         Pusher_OnMove(move_type, *target, move_delta);
                     }
                 } 
                 else {
+                    if (state.proto_idx) {
+                        // 解码列表滚动 (L2 向旧, R2 向新)
+                        int max_scroll = (int)(uart_decoder.log_count < PROTO_LOG_SIZE ? uart_decoder.log_count : PROTO_LOG_SIZE) - PROTO_PANEL_LINES;
+                        if (key == SDLK_PAGEUP && state.proto_scroll < max_scroll) state.proto_scroll++;
+                        else if (key == SDLK_PAGEDOWN && state.proto_scroll > 0) state.proto_scroll--;
+                    }
                     if (key == SDLK_UP) state.zero_pos_y -= 5;
                     else if (key == SDLK_DOWN) state.zero_pos_y += 5;
                 }
@@ -431,33 +1114,57 @@ int main(int argc, char* argv[]) {
         }
 
         if (serial_fd == -1) {
-            serial_fd = serial_open(SERIAL_PORT);
-            if (serial_fd != -1) send_timebase_command(state.time_div_idx);
+            serial_fd = serial_open(serial_port);
+            if (serial_fd != -1) {
+                Parser_Reset(&rx_parser);
+                Cmd_Reset();
+                send_timebase_command(state.time_div_idx);
+            }
         }
 
+        if (state.paused) frame_gap = 1; // 暂停期间设备照常发送, 恢复后的帧与暂停前不连续
         if (!state.paused && serial_fd != -1) {
-            int n = serial_read_bytes(serial_fd, rx_buffer + rx_len, sizeof(rx_buffer) - rx_len);
+            int n = serial_read_bytes(serial_fd, Parser_WritePtr(&rx_parser), Parser_Space(&rx_parser));
             if (n > 0) {
-                rx_len += n;
+                if (record_fp) fwrite(Parser_WritePtr(&rx_parser), 1, n, record_fp);
+                Parser_Commit(&rx_parser, n);
                 last_packet_time = SDL_GetTicks(); 
             }
-            while (rx_len >= FRAME_SIZE) {
-                if (rx_buffer[0] == 0xFA && rx_buffer[1] == 0xFB) {
-                    uint8_t* p = rx_buffer + FRAME_HEADER_SIZE;
-                    for (int i = 0; i < SCREEN_WIDTH; i++) {
-                        uint16_t val = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
-                        data_buffer[i] = (int)val;
-                        p += 2;
-                    }
-                    int remaining = rx_len - FRAME_SIZE;
-                    if (remaining > 0) memmove(rx_buffer, rx_buffer + FRAME_SIZE, remaining);
-                    rx_len = remaining;
+            ParseResult res;
+            uint16_t ack_seq = 0;
+            while ((res = Parser_Next(&rx_parser, frame_samples, &ack_seq)) != PARSE_NONE) {
+                if (rx_parser.junk_before > 0) frame_gap = 1;
+                if (res == PARSE_ACK) {
+                    Cmd_OnAck(ack_seq);
+                } else if (!Cmd_FramesValid()) {
+                    // 时基切换未应答期间的帧仍是旧比例, 直接丢弃
+                    frame_gap = 1;
                 } else {
-                    memmove(rx_buffer, rx_buffer + 1, rx_len - 1);
-                    rx_len--;
+                    memcpy(data_buffer, frame_samples, sizeof(data_buffer));
+                    on_new_frame();
+                    bench_frames++;
+                    if (state.paused) {
+                        // 模板测试失败即暂停: 画面停在失败的那一帧, 同批读到的后续帧全部丢弃
+                        Parser_Reset(&rx_parser);
+                        break;
+                    }
                 }
             }
         }
+        Cmd_Poll(serial_fd);
+        autoset_poll();
+        snap_poll();
+        Stream_Poll();
+
+        // 后台截图完成/失败提示
+        if (Snapshot_SavedCount() != last_snap_saved) {
+            last_snap_saved = Snapshot_SavedCount();
+            show_status("SAVED %d", last_snap_saved);
+        }
+        if (Snapshot_FailedCount() != last_snap_failed) {
+            last_snap_failed = Snapshot_FailedCount();
+            show_status("SNAP ERR");
+        }
         
         int connected = 0;
         if (serial_fd != -1) {
@@ -465,14 +1172,28 @@ int main(int argc, char* argv[]) {
         }
 
         draw_ui(screen, connected);
-        SDL_Flip(screen);
-        SDL_Delay(10);
+        report_dirty(connected);
+        Display_Present();
+        if (bench_loops > 0) {
+            if (++loop_count >= bench_loops) running = 0;
+        } else {
+            SDL_Delay(10);
+        }
+    }
+
+    if (bench_loops > 0) {
+        double us = Time_NowUs() - bench_start;
+        printf("bench: %d loops, %d frames, %.1f us/loop\n", loop_count, bench_frames, us / loop_count);
     }
     
+    if (record_fp) fclose(record_fp);
+    Stream_Shutdown();
+    Snapshot_Shutdown();
     Pusher_Cleanup();
     Audio_Cleanup();
     
     if (serial_fd != -1) serial_close(serial_fd);
+    Display_Close();
     SDL_Quit();
     return 0;
 }
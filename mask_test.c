@@ -0,0 +1,62 @@
+#include "mask_test.h"
+#include <string.h>
+#include "time_util.h"
+
+void Mask_Capture(MaskTest* m, const int* samples, int n, int time_div_idx) {
+    memset(m, 0, sizeof(*m));
+    if (n > MASK_COLS) n = MASK_COLS;
+    memcpy(m->golden_mv, samples, n * sizeof(int));
+    for (int i = n; i < MASK_COLS; i++) m->golden_mv[i] = samples[n - 1];
+    m->time_div_idx = time_div_idx;
+    m->built_volt_idx = -1; // 首次比较前生成包络
+    m->captured = 1;
+}
+
+void Mask_ToScreen(const int* samples, int* ys, int n, int32_t scale_fp, int zero_y) {
+    for (int i = 0; i < n; i++) ys[i] = zero_y - ((samples[i] * scale_fp) >> 16);
+}
+
+void Mask_Build(MaskTest* m, int32_t scale_fp, int zero_y, int volt_div_idx) {
+    int gy[MASK_COLS];
+    Mask_ToScreen(m->golden_mv, gy, MASK_COLS, scale_fp, zero_y);
+
+    // 每列取邻近 ±MASK_TOL_X 列的极值再加垂直容差, 容忍少量水平抖动
+    for (int i = 0; i < MASK_COLS; i++) {
+        int a = i - MASK_TOL_X, b = i + MASK_TOL_X;
+        if (a < 0) a = 0;
+        if (b > MASK_COLS - 1) b = MASK_COLS - 1;
+        int mn = gy[a], mx = gy[a];
+        for (int j = a + 1; j <= b; j++) {
+            if (gy[j] < mn) mn = gy[j];
+            if (gy[j] > mx) mx = gy[j];
+        }
+        m->lo[i] = mn - MASK_TOL_PX;
+        m->hi[i] = mx + MASK_TOL_PX;
+    }
+    m->built_volt_idx = volt_div_idx;
+    m->built_zero_y = zero_y;
+}
+
+int Mask_Check(MaskTest* m, const int* __restrict ys, int n) {
+    uint32_t t0 = Time_NowUs();
+    if (n < MASK_COLS) return -1;
+
+    // 无分支: 比较结果直接累加; 固定列数 + restrict 让 -O2 也能向量化
+    const int* __restrict lo = m->lo;
+    const int* __restrict hi = m->hi;
+    int* __restrict fail = m->fail_col;
+    int count = 0;
+    for (int i = 0; i < MASK_COLS; i++) {
+        int bad = (ys[i] < lo[i]) | (ys[i] > hi[i]);
+        fail[i] = bad;
+        count += bad;
+    }
+
+    m->frames++;
+    if (count) m->fails++;
+    else m->passes++;
+    m->last_fail_cols = count;
+    m->last_us = Time_NowUs() - t0;
+    if (m->last_us > m->max_us) m->max_us = m->last_us;
+    return count;
+}
@@ -0,0 +1,42 @@
+#ifndef MASK_TEST_H
+#define MASK_TEST_H
+
+#include <stdint.h>
+
+// --- 模板 (Mask) 测试 ---
+// 以一帧"黄金波形"生成上下容差包络, 以屏幕坐标逐列存成整数上下界,
+// 之后每帧只做一次无分支的逐列比较 (可被编译器向量化), 统计通过/失败.
+
+#define MASK_COLS    320
+#define MASK_TOL_PX  6   // 垂直容差 (像素)
+#define MASK_TOL_X   2   // 水平容差 (列), 包络取相邻列的极值
+
+typedef struct {
+    int golden_mv[MASK_COLS];  // 黄金波形 (mV), 换挡后据此重建包络
+    int lo[MASK_COLS];         // 每列允许的最小屏幕 y (上边界)
+    int hi[MASK_COLS];         // 每列允许的最大屏幕 y (下边界)
+    int fail_col[MASK_COLS];   // 最近一帧各列是否越界
+    int captured;              // 已采集黄金波形
+    int time_div_idx;          // 采集时的时基, 时基不同则暂停比较
+    int built_volt_idx;        // 包络对应的档位与零点, 变化时重建
+    int built_zero_y;
+
+    // 统计
+    uint32_t frames, passes, fails;
+    int last_fail_cols;        // 最近一帧越界列数
+    uint32_t last_us, max_us;  // 比较耗时
+} MaskTest;
+
+// 采集当前帧为黄金波形并清空统计
+void Mask_Capture(MaskTest* m, const int* samples, int n, int time_div_idx);
+
+// 按当前档位生成屏幕坐标包络 (scale_fp: 每 mV 的像素数, 16.16 定点)
+void Mask_Build(MaskTest* m, int32_t scale_fp, int zero_y, int volt_div_idx);
+
+// 把一帧采样换算为屏幕 y (与包络使用同一定点换算)
+void Mask_ToScreen(const int* samples, int* ys, int n, int32_t scale_fp, int zero_y);
+
+// 比较一帧 (屏幕 y, 至少 MASK_COLS 列), 返回越界列数 (0 为通过), 点数不足返回 -1
+int Mask_Check(MaskTest* m, const int* ys, int n);
+
+#endif
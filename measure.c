@@ -0,0 +1,68 @@
+#include "measure.h"
+
+int Measure_Band(const MeasureResult* m, int* lo, int* hi) {
+    int hyst = (m->max_mv - m->min_mv) * MEASURE_HYST_PERCENT / 100;
+    *lo = m->mean_mv - hyst / 2;
+    *hi = m->mean_mv + hyst / 2;
+    return hyst > 0;
+}
+
+void Measure_FrameWithThreshold(const int* samples, int n, float ms_per_sample, int lo, int hi, MeasureResult* out) {
+    out->min_mv = out->max_mv = out->mean_mv = 0;
+    out->rising_edges = 0;
+    out->trigger_idx = -1;
+    out->period_ms = 0.0f;
+    out->freq_hz = 0.0f;
+    if (n <= 0) return;
+
+    // 极值/均值与带迟滞的上升沿检测在同一遍里完成, 用首末上升沿间距求平均周期
+    int mn = samples[0], mx = samples[0];
+    long sum = 0;
+    int armed = 0; // 先低于 lo 才允许下一次上升沿
+    int first = -1, last = -1;
+    for (int i = 0; i < n; i++) {
+        int v = samples[i];
+        if (v < mn) mn = v;
+        if (v > mx) mx = v;
+        sum += v;
+        if (v < lo) {
+            armed = 1;
+        } else if (armed && v > hi) {
+            armed = 0;
+            if (first < 0) first = i;
+            last = i;
+            out->rising_edges++;
+        }
+    }
+    out->min_mv = mn;
+    out->max_mv = mx;
+    out->mean_mv = (int)(sum / n);
+    out->trigger_idx = first;
+    if (out->rising_edges >= 2 && ms_per_sample > 0.0f) {
+        out->period_ms = (float)(last - first) * ms_per_sample / (float)(out->rising_edges - 1);
+        if (out->period_ms > 0.0f) out->freq_hz = 1000.0f / out->period_ms;
+    }
+}
+
+void Measure_Frame(const int* samples, int n, float ms_per_sample, MeasureResult* out) {
+    // 1. 极值与均值, 得出本帧的迟滞门限
+    MeasureResult range = {0, 0, 0, 0, -1, 0.0f, 0.0f};
+    if (n > 0) {
+        long sum = 0;
+        range.min_mv = range.max_mv = samples[0];
+        for (int i = 0; i < n; i++) {
+            int v = samples[i];
+            if (v < range.min_mv) range.min_mv = v;
+            if (v > range.max_mv) range.max_mv = v;
+            sum += v;
+        }
+        range.mean_mv = (int)(sum / n);
+    }
+    // 2. 用这个门限测量; 无起伏 (门限为空) 时不检测上升沿
+    int lo, hi;
+    if (!Measure_Band(&range, &lo, &hi)) {
+        *out = range;
+        return;
+    }
+    Measure_FrameWithThreshold(samples, n, ms_per_sample, lo, hi, out);
+}
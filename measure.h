@@ -0,0 +1,29 @@
+#ifndef MEASURE_H
+#define MEASURE_H
+
+// --- 单帧自动测量 ---
+// 不依赖 SDL, 主程序与离线分析工具共用
+
+#define MEASURE_HYST_PERCENT 10 // 过零检测迟滞, 占峰峰值的百分比
+
+typedef struct {
+    int min_mv;
+    int max_mv;
+    int mean_mv;
+    int rising_edges;  // 以均值为阈值的上升沿数
+    int trigger_idx;   // 第一个上升沿位置 (触发点), -1 表示无
+    float period_ms;   // 0 表示本帧内不足一个周期
+    float freq_hz;
+} MeasureResult;
+
+// samples: 采样值 (mV), n: 点数, ms_per_sample: 采样间隔
+// 迟滞门限取本帧的均值 ± 峰峰值 x MEASURE_HYST_PERCENT / 2, 需要扫描两遍
+void Measure_Frame(const int* samples, int n, float ms_per_sample, MeasureResult* out);
+
+// 单遍测量: 上升沿按给定门限 [lo, hi] 检测 (例如沿用上一帧的门限), 其余同 Measure_Frame
+void Measure_FrameWithThreshold(const int* samples, int n, float ms_per_sample, int lo, int hi, MeasureResult* out);
+
+// 由测量结果得出 Measure_Frame 使用的迟滞门限; 峰峰值过小 (门限为空) 时返回 0
+int Measure_Band(const MeasureResult* m, int* lo, int* hi);
+
+#endif
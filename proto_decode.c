@@ -0,0 +1,111 @@
+#include "proto_decode.h"
+#include <string.h>
+
+enum { UART_IDLE, UART_START, UART_DATA, UART_STOP };
+
+static void reset_state(ProtoDecoder* d) {
+    d->uart_state = UART_IDLE;
+    d->level = 1;
+    d->bit_idx = 0;
+    d->shift = 0;
+}
+
+void Proto_Init(ProtoDecoder* d, ProtoType type, int baud) {
+    memset(d, 0, sizeof(*d));
+    d->type = type;
+    d->baud = baud;
+    d->thr_hi = PROTO_DEFAULT_THR_MV + PROTO_MIN_SWING_MV / 4;
+    d->thr_lo = PROTO_DEFAULT_THR_MV - PROTO_MIN_SWING_MV / 4;
+    reset_state(d);
+}
+
+void Proto_Gap(ProtoDecoder* d) {
+    reset_state(d);
+}
+
+static void emit(ProtoDecoder* d, uint8_t value, int framing_error) {
+    ProtoByte* b = &d->log[d->log_count % PROTO_LOG_SIZE];
+    b->value = value;
+    b->framing_error = (uint8_t)framing_error;
+    b->x = d->start_x;
+    b->frame_no = d->frame_no;
+    d->log_count++;
+}
+
+// 更新判决门限: 取峰峰值的 40% / 60% 处, 信号太小时保持不变
+static void update_threshold(ProtoDecoder* d, const int* samples, int n) {
+    int mn = samples[0], mx = samples[0];
+    for (int i = 1; i < n; i++) {
+        if (samples[i] < mn) mn = samples[i];
+        if (samples[i] > mx) mx = samples[i];
+    }
+    int pp = mx - mn;
+    if (pp < PROTO_MIN_SWING_MV) return;
+    d->thr_lo = mn + pp * 2 / 5;
+    d->thr_hi = mn + pp * 3 / 5;
+}
+
+static void feed_uart(ProtoDecoder* d, const int* samples, int n) {
+    for (int i = 0; i < n; i++) {
+        int v = samples[i];
+        int prev = d->level;
+        if (v > d->thr_hi) d->level = 1;
+        else if (v < d->thr_lo) d->level = 0;
+
+        if (d->uart_state == UART_IDLE) {
+            // 下降沿即起始位, 第一个判决点落在起始位中央
+            if (prev == 1 && d->level == 0) {
+                d->start_x = i;
+                d->next_pt = ((int64_t)i << 16) + d->bit_fp / 2;
+                d->uart_state = UART_START;
+            }
+            continue;
+        }
+        if (((int64_t)i << 16) < d->next_pt) continue;
+
+        d->next_pt += d->bit_fp;
+        switch (d->uart_state) {
+            case UART_START:
+                if (d->level != 0) { d->uart_state = UART_IDLE; break; } // 毛刺
+                d->uart_state = UART_DATA;
+                d->bit_idx = 0;
+                d->shift = 0;
+                break;
+            case UART_DATA:
+                d->shift |= (uint8_t)(d->level << d->bit_idx); // LSB 先发
+                if (++d->bit_idx == 8) d->uart_state = UART_STOP;
+                break;
+            case UART_STOP:
+                emit(d, d->shift, d->level == 0);
+                d->uart_state = UART_IDLE;
+                break;
+        }
+    }
+}
+
+void Proto_Feed(ProtoDecoder* d, const int* samples, int n, float us_per_sample) {
+    if (d->type == PROTO_OFF || n <= 0) return;
+
+    if (us_per_sample != d->us_per_sample) {
+        // 时基变化: 采样间隔不同, 未完成的字节作废
+        d->us_per_sample = us_per_sample;
+        reset_state(d);
+        float bit_samples = 1e6f / (float)d->baud / us_per_sample;
+        d->bit_fp = (int64_t)(bit_samples * 65536.0f);
+        d->undersampled = bit_samples < PROTO_MIN_BIT_SAMPLES;
+    }
+    if (d->undersampled) { d->frame_no++; return; }
+
+    update_threshold(d, samples, n);
+    if (d->type == PROTO_UART) feed_uart(d, samples, n);
+
+    // 状态跨帧保留: 位置换算到下一帧的坐标系
+    d->next_pt -= (int64_t)n << 16;
+    d->start_x -= n;
+    d->frame_no++;
+}
+
+const ProtoByte* Proto_Get(const ProtoDecoder* d, uint32_t i) {
+    if (i >= d->log_count || i >= PROTO_LOG_SIZE) return NULL;
+    return &d->log[(d->log_count - 1 - i) % PROTO_LOG_SIZE];
+}
@@ -0,0 +1,66 @@
+#ifndef PROTO_DECODE_H
+#define PROTO_DECODE_H
+
+#include <stdint.h>
+
+// --- 串行协议解码 ---
+// 流式状态机, 每收到一帧采样调用一次 Proto_Feed, 解码状态跨帧保留,
+// 重绘时只读取已解出的结果, 不回头重新解码历史数据.
+// 目前只有一路采集通道, 只支持单线的 UART (8N1); I2C/SPI 需要时钟+数据两路.
+
+#define PROTO_LOG_SIZE        256   // 保存的已解码字节数 (环形)
+#define PROTO_MIN_SWING_MV    200   // 峰峰值低于此值时沿用上次的判决门限
+#define PROTO_DEFAULT_THR_MV  1650  // 初始门限 (3.3V 逻辑)
+#define PROTO_MIN_BIT_SAMPLES 3     // 每位至少需要的采样点数, 否则标记欠采样
+
+typedef enum {
+    PROTO_OFF,
+    PROTO_UART
+} ProtoType;
+
+typedef struct {
+    uint8_t value;
+    uint8_t framing_error; // 停止位为 0
+    int x;                 // 起始位在所属帧中的采样位置, 负数表示始于更早的帧
+    uint32_t frame_no;     // 完成解码时的帧号
+} ProtoByte;
+
+typedef struct {
+    // 配置
+    ProtoType type;
+    int baud;
+
+    // 门限 (带迟滞)
+    int thr_hi, thr_lo;
+    int level;               // 当前逻辑电平
+
+    // UART 状态机
+    int uart_state;
+    int64_t next_pt;         // 下一个采样判决点 (16.16 定点, 相对本帧起点)
+    int64_t bit_fp;          // 每位采样数 (16.16 定点)
+    int bit_idx;
+    uint8_t shift;
+    int start_x;
+    float us_per_sample;
+    int undersampled;        // 采样率不足以解码当前波特率
+
+    // 输出
+    ProtoByte log[PROTO_LOG_SIZE];
+    uint32_t log_count;      // 累计解出的字节数
+    uint32_t frame_no;       // 已处理的帧数
+} ProtoDecoder;
+
+// 设定协议类型与波特率, 并清空状态与记录
+void Proto_Init(ProtoDecoder* d, ProtoType type, int baud);
+
+// 与上一帧之间有数据丢失 (暂停、丢帧、串口重同步) 时在 Proto_Feed 之前调用:
+// 丢弃跨越缺口的未完成字节, 回到空闲状态
+void Proto_Gap(ProtoDecoder* d);
+
+// 送入一帧采样 (mV), us_per_sample 变化 (切换时基) 时自动重置状态机
+void Proto_Feed(ProtoDecoder* d, const int* samples, int n, float us_per_sample);
+
+// 取第 i 新的字节 (0 为最新), 不存在返回 NULL
+const ProtoByte* Proto_Get(const ProtoDecoder* d, uint32_t i);
+
+#endif
@@ -6,8 +6,34 @@
 #include <sys/ioctl.h>
 #include <errno.h>
 #include <string.h>
+#include <sys/stat.h>
+#include "serial_synth.h"
+
+// --- 回放 / 合成数据源 ---
+// 回放每次读取最多给出一帧数据, 模拟设备的发送节奏
+#define SERIAL_REPLAY_CHUNK Synth_FrameSize
+
+static int replay_fd = -1;
+static int synth_fd = -1;
+
+static int open_standin(const char* port_name) {
+    if (strcmp(port_name, SERIAL_SYNTH_NAME) == 0) {
+        synth_fd = open("/dev/null", O_RDWR);
+        Synth_Reset();
+        return synth_fd;
+    }
+    struct stat st;
+    if (stat(port_name, &st) == 0 && S_ISREG(st.st_mode)) {
+        replay_fd = open(port_name, O_RDONLY);
+        return replay_fd;
+    }
+    return -2; // 不是替身数据源, 按真实串口打开
+}
 
 int serial_open(const char* port_name) {
+    int standin = open_standin(port_name);
+    if (standin != -2) return standin;
+
     // 1. 阻塞模式打开
     int fd = open(port_name, O_RDWR | O_NOCTTY);
     if (fd == -1) {
@@ -71,9 +97,29 @@ int serial_open(const char* port_name) {
 
 int serial_read_bytes(int fd, uint8_t* buffer, int max_len) {
     if (fd < 0) return -1;
+    if (fd == synth_fd) return Synth_Read(buffer, max_len);
+    if (fd == replay_fd) {
+        if (max_len > SERIAL_REPLAY_CHUNK) max_len = SERIAL_REPLAY_CHUNK;
+        int n = read(fd, buffer, max_len);
+        if (n == 0) { // 读到末尾从头回放
+            lseek(fd, 0, SEEK_SET);
+            n = read(fd, buffer, max_len);
+        }
+        return n;
+    }
     return read(fd, buffer, max_len);
 }
 
+// 非阻塞写, 可能只写出一部分, 返回实际写出的字节数
+int serial_write_bytes(int fd, const uint8_t* buffer, int len) {
+    if (fd < 0) return -1;
+    if (fd == synth_fd) { Synth_Command(buffer, len); return len; }
+    if (fd == replay_fd) return len; // 录制数据不响应命令, 由命令通道按超时处理
+    return write(fd, buffer, len);
+}
+
 void serial_close(int fd) {
+    if (fd == synth_fd) synth_fd = -1;
+    if (fd == replay_fd) replay_fd = -1;
     if (fd >= 0) close(fd);
 }
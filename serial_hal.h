@@ -2,8 +2,14 @@
 #define SERIAL_HAL_H
 #include <stdint.h>
 
+// --- 无设备数据源 (PGO 训练 / 基准测试) ---
+// port_name 为普通文件时按录制数据 (SCOPE_RECORD 的输出) 循环回放,
+// 为 SERIAL_SYNTH_NAME 时生成合成波形并应答时基命令
+#define SERIAL_SYNTH_NAME "synth"
+
 int serial_open(const char* port_name);
 int serial_read_bytes(int fd, uint8_t* buffer, int max_len);
+int serial_write_bytes(int fd, const uint8_t* buffer, int len);
 void serial_close(int fd);
 
 #endif
@@ -0,0 +1,84 @@
+#include "serial_synth.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "frame_parser.h"
+
+// 合成的是一个固定频率的信号, 按当前时基采样: 时基越慢每周期的采样点越少,
+// 最慢几档会像真实设备一样欠采样混叠
+#define SYNTH_SIGNAL_HZ      1000.0f // 探头校准方波的常见频率
+#define SYNTH_SAMPLES_PER_DIV 30     // 与主程序 GRID_SIZE 一致: 每格一个像素一个采样点
+#define SYNTH_INITIAL_TB     1       // 与主程序的初始时基档位一致 (1ms/div)
+
+extern float TIME_PER_DIV[];         // 时基表在 main.c, 命令里只带档位下标
+extern const int TIME_LEVELS;
+
+const int Synth_FrameSize = FRAME_SIZE;
+
+static uint8_t synth_buf[FRAME_SIZE + ACK_SIZE * 4];
+static int synth_len = 0, synth_pos = 0;
+static int synth_acks = 0;     // 待回送的应答数
+static uint16_t synth_seq[4];
+static float synth_step = 0.0f;  // 每个采样点前进的周期数, 随时基档位变化
+static float synth_cycle = 0.0f; // 当前相位 [0, 1)
+static uint32_t synth_phase = 0; // 采样点计数, 用于噪声
+
+static void synth_set_timebase(int idx) {
+    if (idx < 0 || idx >= TIME_LEVELS) return;
+    float ms_per_sample = TIME_PER_DIV[idx] / SYNTH_SAMPLES_PER_DIV;
+    synth_step = SYNTH_SIGNAL_HZ * ms_per_sample / 1000.0f;
+}
+
+// 正弦 + 少量方波与噪声, 幅度在 0.5V~2.8V 之间, 覆盖测量/解码的常见分支
+static void synth_fill(void) {
+    synth_len = synth_pos = 0;
+    for (int i = 0; i < synth_acks; i++) {
+        synth_buf[synth_len++] = FRAME_SYNC_0;
+        synth_buf[synth_len++] = FRAME_SYNC_ACK;
+        synth_buf[synth_len++] = synth_seq[i] & 0xFF;
+        synth_buf[synth_len++] = synth_seq[i] >> 8;
+    }
+    synth_acks = 0;
+
+    synth_buf[synth_len++] = FRAME_SYNC_0;
+    synth_buf[synth_len++] = FRAME_SYNC_DATA;
+    for (int i = 0; i < FRAME_POINTS; i++, synth_phase++) {
+        float t = synth_cycle;
+        synth_cycle += synth_step;
+        synth_cycle -= floorf(synth_cycle);
+        int mv = 1650 + (int)(900.0f * sinf(t * 6.2831853f));
+        mv += (t < 0.5f) ? 150 : -150;
+        mv += (int)((synth_phase * 2654435761u) >> 27) - 16;
+        synth_buf[synth_len++] = mv & 0xFF;
+        synth_buf[synth_len++] = (mv >> 8) & 0xFF;
+    }
+}
+
+void Synth_Reset(void) {
+    synth_len = synth_pos = synth_acks = 0;
+    synth_set_timebase(SYNTH_INITIAL_TB);
+}
+
+// 每次最多给出一帧 (连同排队的应答), 模拟设备的发送节奏
+int Synth_Read(uint8_t* buffer, int max_len) {
+    if (synth_pos >= synth_len) synth_fill();
+    int n = synth_len - synth_pos;
+    if (n > max_len) n = max_len;
+    memcpy(buffer, synth_buf + synth_pos, n);
+    synth_pos += n;
+    return n;
+}
+
+// 解析 "TIM:<idx>,<seq>\n", 按新时基采样并排队应答
+void Synth_Command(const uint8_t* buffer, int len) {
+    char line[32];
+    if (len >= (int)sizeof(line)) len = sizeof(line) - 1;
+    memcpy(line, buffer, len);
+    line[len] = 0;
+    int idx;
+    unsigned seq;
+    if (sscanf(line, "TIM:%d,%u", &idx, &seq) == 2) {
+        synth_set_timebase(idx);
+        if (synth_acks < 4) synth_seq[synth_acks++] = (uint16_t)seq;
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef SERIAL_SYNTH_H
+#define SERIAL_SYNTH_H
+#include <stdint.h>
+
+// --- 合成数据源 (SERIAL_SYNTH_NAME) ---
+// 按设备协议编码波形帧和应答帧, 串口 HAL 只负责把字节交给调用者,
+// 不需要了解帧格式. 时基命令改变合成波形的周期并排队应答.
+
+// 一帧波形的字节数 (FRAME_SIZE); 录制回放也按此分块, 模拟设备的发送节奏
+extern const int Synth_FrameSize;
+
+void Synth_Reset(void);
+int Synth_Read(uint8_t* buffer, int max_len);
+void Synth_Command(const uint8_t* buffer, int len);
+
+#endif
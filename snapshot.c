@@ -0,0 +1,197 @@
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+// --- 预分配槽位 ---
+typedef struct {
+    Uint16 pixels[SNAPSHOT_WIDTH * SNAPSHOT_HEIGHT];
+    int samples[SNAPSHOT_POINTS];
+    int n;
+    float ms_per_sample;
+    char time_div[16];
+    char volt_div[16];
+} SnapshotSlot;
+
+static SnapshotSlot* slots = NULL;
+static int slot_busy[SNAPSHOT_SLOTS];   // 1: 已交给后台线程
+static int queue[SNAPSHOT_SLOTS];       // 待写槽位 (先进先出)
+static int q_head = 0, q_count = 0;
+
+static pthread_t worker;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static int running = 0;
+
+static volatile int saved_count = 0;
+static volatile int failed_count = 0;
+static int next_index = 0;
+
+static void put_le16(Uint8* p, Uint32 v) { p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; }
+static void put_le32(Uint8* p, Uint32 v) { put_le16(p, v & 0xFFFF); put_le16(p + 2, v >> 16); }
+
+// RGB565 -> 24 位 BMP (自下而上存储, 行对齐 4 字节)
+static int write_bmp(const char* path, const SnapshotSlot* s) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return -1;
+
+    int row_bytes = (SNAPSHOT_WIDTH * 3 + 3) & ~3;
+    Uint32 img_size = row_bytes * SNAPSHOT_HEIGHT;
+    Uint8 hdr[54];
+    memset(hdr, 0, sizeof(hdr));
+    hdr[0] = 'B'; hdr[1] = 'M';
+    put_le32(hdr + 2, 54 + img_size);
+    put_le32(hdr + 10, 54);
+    put_le32(hdr + 14, 40);
+    put_le32(hdr + 18, SNAPSHOT_WIDTH);
+    put_le32(hdr + 22, SNAPSHOT_HEIGHT);
+    put_le16(hdr + 26, 1);
+    put_le16(hdr + 28, 24);
+    put_le32(hdr + 34, img_size);
+    int ok = fwrite(hdr, 1, sizeof(hdr), fp) == sizeof(hdr);
+
+    Uint8 row[(SNAPSHOT_WIDTH * 3 + 3) & ~3];
+    memset(row, 0, sizeof(row));
+    for (int y = SNAPSHOT_HEIGHT - 1; y >= 0 && ok; y--) {
+        const Uint16* src = s->pixels + y * SNAPSHOT_WIDTH;
+        for (int x = 0; x < SNAPSHOT_WIDTH; x++) {
+            Uint16 c = src[x];
+            Uint8 r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+            row[x * 3 + 0] = (b << 3) | (b >> 2);
+            row[x * 3 + 1] = (g << 2) | (g >> 4);
+            row[x * 3 + 2] = (r << 3) | (r >> 2);
+        }
+        ok = fwrite(row, 1, row_bytes, fp) == (size_t)row_bytes;
+    }
+    // 卡满时 fwrite 或 fclose (刷出缓冲) 才会失败, 两者都要检查
+    if (fclose(fp) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+static int write_csv(const char* path, const SnapshotSlot* s) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return -1;
+    fprintf(fp, "# time/div %s, volt/div %s\n", s->time_div, s->volt_div);
+    fprintf(fp, "index,time_ms,mv\n");
+    for (int i = 0; i < s->n; i++) {
+        fprintf(fp, "%d,%.4f,%d\n", i, i * s->ms_per_sample, s->samples[i]);
+    }
+    int ok = !ferror(fp);
+    if (fclose(fp) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+static void save_slot(const SnapshotSlot* s) {
+    char bmp_path[64], csv_path[64];
+    mkdir(SNAPSHOT_DIR, 0755);
+
+    // 跳过已存在的编号, 不覆盖上次运行的截图
+    for (;;) {
+        snprintf(bmp_path, sizeof(bmp_path), SNAPSHOT_DIR "/snap_%04d.bmp", next_index);
+        if (access(bmp_path, F_OK) != 0) break;
+        next_index++;
+    }
+    snprintf(csv_path, sizeof(csv_path), SNAPSHOT_DIR "/snap_%04d.csv", next_index);
+    next_index++;
+
+    if (write_bmp(bmp_path, s) == 0 && write_csv(csv_path, s) == 0) {
+        saved_count++;
+    } else {
+        fprintf(stderr, "Snapshot write failed: %s\n", bmp_path);
+        // 不留下写了一半的文件
+        remove(bmp_path);
+        remove(csv_path);
+        failed_count++;
+    }
+}
+
+static void* worker_main(void* arg) {
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        while (running && q_count == 0) pthread_cond_wait(&wake, &lock);
+        if (q_count == 0) break; // 已要求退出且队列写空
+
+        int idx = queue[q_head];
+        q_head = (q_head + 1) % SNAPSHOT_SLOTS;
+        q_count--;
+
+        // 写文件时不持锁, 渲染线程可继续提交
+        pthread_mutex_unlock(&lock);
+        save_slot(&slots[idx]);
+        pthread_mutex_lock(&lock);
+        slot_busy[idx] = 0;
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+int Snapshot_Init(void) {
+    slots = (SnapshotSlot*)calloc(SNAPSHOT_SLOTS, sizeof(SnapshotSlot));
+    if (!slots) return -1;
+    running = 1;
+    if (pthread_create(&worker, NULL, worker_main, NULL) != 0) {
+        running = 0;
+        free(slots);
+        slots = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int Snapshot_Request(SDL_Surface* screen, const int* samples, int n, const SnapshotMeta* meta) {
+    if (!slots || !running) return -1;
+
+    // 只在取槽位时短暂持锁
+    int idx = -1;
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < SNAPSHOT_SLOTS; i++) {
+        if (!slot_busy[i]) { idx = i; slot_busy[i] = 1; break; }
+    }
+    pthread_mutex_unlock(&lock);
+    if (idx < 0) return -1;
+
+    SnapshotSlot* s = &slots[idx];
+    int w = screen->w < SNAPSHOT_WIDTH ? screen->w : SNAPSHOT_WIDTH;
+    int h = screen->h < SNAPSHOT_HEIGHT ? screen->h : SNAPSHOT_HEIGHT;
+    if (SDL_MUSTLOCK(screen)) SDL_LockSurface(screen);
+    for (int y = 0; y < h; y++) {
+        memcpy(s->pixels + y * SNAPSHOT_WIDTH, (Uint8*)screen->pixels + y * screen->pitch, w * 2);
+    }
+    if (SDL_MUSTLOCK(screen)) SDL_UnlockSurface(screen);
+
+    if (n > SNAPSHOT_POINTS) n = SNAPSHOT_POINTS;
+    memcpy(s->samples, samples, n * sizeof(int));
+    s->n = n;
+    s->ms_per_sample = meta->ms_per_sample;
+    snprintf(s->time_div, sizeof(s->time_div), "%s", meta->time_div_str);
+    snprintf(s->volt_div, sizeof(s->volt_div), "%s", meta->volt_div_str);
+
+    pthread_mutex_lock(&lock);
+    queue[(q_head + q_count) % SNAPSHOT_SLOTS] = idx;
+    q_count++;
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    return 0;
+}
+
+int Snapshot_SavedCount(void) {
+    return saved_count;
+}
+
+int Snapshot_FailedCount(void) {
+    return failed_count;
+}
+
+void Snapshot_Shutdown(void) {
+    if (!slots) return;
+    pthread_mutex_lock(&lock);
+    running = 0;
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    pthread_join(worker, NULL);
+    free(slots);
+    slots = NULL;
+}
@@ -0,0 +1,36 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <SDL/SDL.h>
+
+// --- 截图与波形导出 ---
+// 渲染线程只把当前画面和采样拷进预分配的槽位, 编码 BMP / CSV 和写 SD 卡
+// 全部在后台线程完成. 槽位用完时请求直接失败, 由调用方提示"队列满".
+
+#define SNAPSHOT_SLOTS   3             // 排队深度
+#define SNAPSHOT_DIR     "snapshots"   // 输出目录 (相对运行目录)
+#define SNAPSHOT_WIDTH   320
+#define SNAPSHOT_HEIGHT  240
+#define SNAPSHOT_POINTS  320
+
+typedef struct {
+    float ms_per_sample;
+    const char* time_div_str;
+    const char* volt_div_str;
+} SnapshotMeta;
+
+// 启动后台线程, 返回 0 成功
+int Snapshot_Init(void);
+
+// 提交一次截图 (16 位表面 + 采样点)
+// 返回: 0 已入队, -1 队列满或未初始化
+int Snapshot_Request(SDL_Surface* screen, const int* samples, int n, const SnapshotMeta* meta);
+
+// 已完成 / 失败的截图数 (后台线程累加), 用于界面提示
+int Snapshot_SavedCount(void);
+int Snapshot_FailedCount(void);
+
+// 写完已排队的截图后退出后台线程
+void Snapshot_Shutdown(void);
+
+#endif
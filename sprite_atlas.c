@@ -0,0 +1,235 @@
+#include "sprite_atlas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "time_util.h"
+
+static void layout_rows(SpriteAtlas* a) {
+    a->row_y[ATLAS_RIGHT] = 0;
+    a->row_y[ATLAS_LEFT]  = a->frame_h;
+    a->row_y[ATLAS_DOWN]  = a->frame_h * 2;
+    a->row_y[ATLAS_UP]    = a->frame_h * 2 + a->frame_w;
+}
+
+static int sheet_w(const SpriteAtlas* a) {
+    return (a->frame_w > a->frame_h ? a->frame_w : a->frame_h) * a->frames;
+}
+
+static int sheet_h(const SpriteAtlas* a) {
+    return (a->frame_h + a->frame_w) * 2;
+}
+
+// 源图比缓存新 (或缓存不存在) 时需要重建
+static int cache_is_fresh(const char* bmp_path, const char* cache_path) {
+    struct stat src_st, cache_st;
+    if (stat(cache_path, &cache_st) != 0) return 0;
+    if (stat(bmp_path, &src_st) != 0) return 1; // 只有缓存也能用
+    return cache_st.st_mtime >= src_st.st_mtime;
+}
+
+// 缓存文件: 文件头 + 显示格式的原始像素. 命中时逐行读入即可使用,
+// 不再做 BMP 解码和格式转换; 图集尺寸或显示格式 (位深/掩码) 不符时视为失效
+#define ATLAS_CACHE_MAGIC "ATL1"
+
+typedef struct {
+    char magic[4];
+    Uint32 w, h, bpp;
+    Uint32 rmask, gmask, bmask;
+} AtlasCacheHeader;
+
+static void cache_header(AtlasCacheHeader* hd, int w, int h, const SDL_PixelFormat* f) {
+    memset(hd, 0, sizeof(*hd));
+    memcpy(hd->magic, ATLAS_CACHE_MAGIC, 4);
+    hd->w = (Uint32)w;
+    hd->h = (Uint32)h;
+    hd->bpp = f->BitsPerPixel;
+    hd->rmask = f->Rmask;
+    hd->gmask = f->Gmask;
+    hd->bmask = f->Bmask;
+}
+
+static SDL_Surface* cache_load(const SpriteAtlas* a, const char* cache_path) {
+    SDL_Surface* screen = SDL_GetVideoSurface();
+    if (!screen) return NULL;
+    FILE* fp = fopen(cache_path, "rb");
+    if (!fp) return NULL;
+
+    const SDL_PixelFormat* f = screen->format;
+    AtlasCacheHeader want, got;
+    cache_header(&want, sheet_w(a), sheet_h(a), f);
+    SDL_Surface* sheet = NULL;
+    if (fread(&got, sizeof(got), 1, fp) == 1 && memcmp(&got, &want, sizeof(want)) == 0) {
+        sheet = SDL_CreateRGBSurface(SDL_SWSURFACE, sheet_w(a), sheet_h(a), f->BitsPerPixel,
+                                     f->Rmask, f->Gmask, f->Bmask, 0);
+    }
+    if (sheet) {
+        int row = sheet->w * f->BytesPerPixel;
+        SDL_LockSurface(sheet);
+        for (int y = 0; y < sheet->h; y++) {
+            if (fread((Uint8*)sheet->pixels + y * sheet->pitch, row, 1, fp) != 1) {
+                SDL_UnlockSurface(sheet);
+                SDL_FreeSurface(sheet); // 文件不完整
+                sheet = NULL;
+                break;
+            }
+        }
+        if (sheet) SDL_UnlockSurface(sheet);
+    }
+    fclose(fp);
+    return sheet;
+}
+
+static int cache_save(SDL_Surface* sheet, const char* cache_path) {
+    FILE* fp = fopen(cache_path, "wb");
+    if (!fp) return -1;
+    AtlasCacheHeader hd;
+    cache_header(&hd, sheet->w, sheet->h, sheet->format);
+    int ok = fwrite(&hd, sizeof(hd), 1, fp) == 1;
+    int row = sheet->w * sheet->format->BytesPerPixel;
+    SDL_LockSurface(sheet);
+    for (int y = 0; ok && y < sheet->h; y++) {
+        ok = fwrite((Uint8*)sheet->pixels + y * sheet->pitch, row, 1, fp) == 1;
+    }
+    SDL_UnlockSurface(sheet);
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) remove(cache_path); // 不留半个缓存
+    return ok ? 0 : -1;
+}
+
+// 从源动画条生成四方向图集 (32位中间格式, 只在缓存失效时执行)
+static SDL_Surface* build_sheet(const SpriteAtlas* a, const char* bmp_path, Uint8 kr, Uint8 kg, Uint8 kb) {
+    SDL_Surface* raw = SDL_LoadBMP(bmp_path);
+    if (!raw) return NULL;
+    if (raw->w < a->frame_w * a->frames || raw->h < a->frame_h) {
+        SDL_FreeSurface(raw);
+        return NULL;
+    }
+
+    // 统一转成 32 位, 变换循环里不再按 BytesPerPixel 分支
+    SDL_Surface* src = SDL_CreateRGBSurface(SDL_SWSURFACE, raw->w, raw->h, 32,
+                                            0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+    SDL_Surface* dst = SDL_CreateRGBSurface(SDL_SWSURFACE, sheet_w(a), sheet_h(a), 32,
+                                            0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+    if (!src || !dst) {
+        if (src) SDL_FreeSurface(src);
+        if (dst) SDL_FreeSurface(dst);
+        SDL_FreeSurface(raw);
+        return NULL;
+    }
+    SDL_BlitSurface(raw, NULL, src, NULL);
+    SDL_FreeSurface(raw);
+    SDL_FillRect(dst, NULL, SDL_MapRGB(dst->format, kr, kg, kb));
+
+    SDL_LockSurface(src);
+    SDL_LockSurface(dst);
+    int w = a->frame_w, h = a->frame_h;
+    int sp = src->pitch / 4, dp = dst->pitch / 4;
+    Uint32* sp0 = (Uint32*)src->pixels;
+    Uint32* dp0 = (Uint32*)dst->pixels;
+
+    for (int f = 0; f < a->frames; f++) {
+        int sx = f * w;
+        for (int y = 0; y < h; y++) {
+            const Uint32* s = sp0 + y * sp + sx;
+            Uint32* right = dp0 + (a->row_y[ATLAS_RIGHT] + y) * dp + f * w;
+            Uint32* left  = dp0 + (a->row_y[ATLAS_LEFT] + y) * dp + f * w;
+            for (int x = 0; x < w; x++) {
+                Uint32 px = s[x];
+                right[x] = px;
+                left[w - 1 - x] = px;
+                // 顺时针: (x, y) -> (h-1-y, x)
+                dp0[(a->row_y[ATLAS_DOWN] + x) * dp + f * h + (h - 1 - y)] = px;
+                // 逆时针: (x, y) -> (y, w-1-x)
+                dp0[(a->row_y[ATLAS_UP] + (w - 1 - x)) * dp + f * h + y] = px;
+            }
+        }
+    }
+    SDL_UnlockSurface(dst);
+    SDL_UnlockSurface(src);
+    SDL_FreeSurface(src);
+    return dst;
+}
+
+SpriteAtlas* Atlas_Load(const char* bmp_path, const char* cache_path,
+                        int frame_w, int frame_h, int frames,
+                        Uint8 key_r, Uint8 key_g, Uint8 key_b) {
+    Uint32 t0 = Time_NowUs();
+    SpriteAtlas* a = (SpriteAtlas*)calloc(1, sizeof(SpriteAtlas));
+    if (!a) return NULL;
+    a->frame_w = frame_w;
+    a->frame_h = frame_h;
+    a->frames = frames;
+    layout_rows(a);
+
+    // 1. 优先使用缓存 (已是显示格式)
+    SDL_Surface* sheet = NULL;
+    if (cache_path && cache_is_fresh(bmp_path, cache_path)) {
+        sheet = cache_load(a, cache_path);
+        if (sheet) a->from_cache = 1;
+    }
+
+    // 2. 缓存失效则重建, 转为屏幕格式后回写
+    if (!sheet) {
+        sheet = build_sheet(a, bmp_path, key_r, key_g, key_b);
+        if (!sheet) {
+            free(a);
+            return NULL;
+        }
+        SDL_Surface* disp = SDL_DisplayFormat(sheet);
+        if (disp) {
+            SDL_FreeSurface(sheet);
+            sheet = disp;
+        }
+        if (cache_path && cache_save(sheet, cache_path) != 0) {
+            fprintf(stderr, "Atlas cache write failed: %s\n", cache_path);
+        }
+    }
+
+    // 3. 开启 RLE 透明色加速
+    SDL_SetColorKey(sheet, SDL_SRCCOLORKEY | SDL_RLEACCEL, SDL_MapRGB(sheet->format, key_r, key_g, key_b));
+    a->sheet = sheet;
+
+    a->load_us = Time_NowUs() - t0;
+    printf("Atlas %s: %s, %u us\n", bmp_path, a->from_cache ? "cache hit" : "rebuilt", (unsigned)a->load_us);
+    return a;
+}
+
+void Atlas_Free(SpriteAtlas* a) {
+    if (!a) return;
+    if (a->blit_count > 0) {
+        printf("Atlas blits: %u, avg %u us\n", (unsigned)a->blit_count,
+               (unsigned)(a->blit_us_total / a->blit_count));
+    }
+    if (a->sheet) SDL_FreeSurface(a->sheet);
+    free(a);
+}
+
+void Atlas_FrameSize(const SpriteAtlas* a, AtlasOrient orient, int* w, int* h) {
+    if (orient == ATLAS_DOWN || orient == ATLAS_UP) {
+        *w = a->frame_h;
+        *h = a->frame_w;
+    } else {
+        *w = a->frame_w;
+        *h = a->frame_h;
+    }
+}
+
+void Atlas_Blit(SpriteAtlas* a, AtlasOrient orient, int frame, SDL_Surface* dst, int x, int y) {
+    if (!a || !a->sheet || orient < 0 || orient >= ATLAS_ORIENT_COUNT) return;
+    if (frame < 0 || frame >= a->frames) return;
+    int w, h;
+    Atlas_FrameSize(a, orient, &w, &h);
+    if (x <= -w || x >= dst->w || y <= -h || y >= dst->h) return;
+
+    SDL_Rect src_rect = { frame * w, a->row_y[orient], w, h };
+    SDL_Rect dst_rect = { x, y, 0, 0 };
+#ifdef SCOPE_PROFILE
+    Uint32 t0 = Time_NowUs();
+    SDL_BlitSurface(a->sheet, &src_rect, dst, &dst_rect);
+    a->blit_us_total += Time_NowUs() - t0;
+    a->blit_count++;
+#else
+    SDL_BlitSurface(a->sheet, &src_rect, dst, &dst_rect);
+#endif
+}
@@ -0,0 +1,52 @@
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include <SDL/SDL.h>
+
+// --- 精灵图集 ---
+// 从一张横排动画条 (BMP) 生成 右/左/下/上 四个方向, 合并为一张图集:
+//   行0: 原图 (Right)       单帧 frame_w x frame_h
+//   行1: 水平镜像 (Left)     单帧 frame_w x frame_h
+//   行2: 顺时针90度 (Down)   单帧 frame_h x frame_w
+//   行3: 逆时针90度 (Up)     单帧 frame_h x frame_w
+// 图集一次性转换为屏幕格式并开启 RLE 透明色加速, 每帧 Blit 无需再做格式转换.
+// 转换后的图集按显示格式原样缓存到磁盘, 源图未更新时下次启动直接读入, 不再解码和转换.
+
+typedef enum {
+    ATLAS_RIGHT,
+    ATLAS_LEFT,
+    ATLAS_DOWN,
+    ATLAS_UP,
+    ATLAS_ORIENT_COUNT
+} AtlasOrient;
+
+typedef struct {
+    SDL_Surface* sheet;              // 显示格式图集
+    int frame_w, frame_h, frames;    // 原图单帧尺寸与帧数
+    int row_y[ATLAS_ORIENT_COUNT];   // 各方向所在行的起始 y
+    // 性能统计
+    int from_cache;                  // 1: 本次从缓存加载
+    Uint32 load_us;                  // 加载+变换+转换总耗时
+    Uint32 blit_count;               // 以下两项只在 SCOPE_PROFILE 编译时统计
+    Uint32 blit_us_total;
+} SpriteAtlas;
+
+// 加载图集
+// bmp_path:   源动画条
+// cache_path: 缓存文件, 传 NULL 不使用缓存
+// key_r/g/b:  透明色
+// 返回: 成功返回图集, 失败返回 NULL
+SpriteAtlas* Atlas_Load(const char* bmp_path, const char* cache_path,
+                        int frame_w, int frame_h, int frames,
+                        Uint8 key_r, Uint8 key_g, Uint8 key_b);
+
+// 释放图集并打印性能统计 (Blit 计时需 SCOPE_PROFILE)
+void Atlas_Free(SpriteAtlas* atlas);
+
+// 指定方向的单帧尺寸 (旋转方向宽高互换)
+void Atlas_FrameSize(const SpriteAtlas* atlas, AtlasOrient orient, int* w, int* h);
+
+// 绘制一帧, (x, y) 为左上角
+void Atlas_Blit(SpriteAtlas* atlas, AtlasOrient orient, int frame, SDL_Surface* dst, int x, int y);
+
+#endif
@@ -0,0 +1,63 @@
+#include "stats.h"
+#include <math.h>
+#include <string.h>
+
+void Stats_Reset(RunningStat* s, float range) {
+    memset(s, 0, sizeof(*s));
+    s->h_range = (isfinite(range) && range > 0.0f) ? range : 0.0f;
+}
+
+// 量程翻倍: 相邻两桶合并为一桶; grow_down 为 1 时旧量程落在新量程的上半部分
+static void hist_double(RunningStat* s, int grow_down) {
+    uint32_t merged[STATS_BUCKETS / 2];
+    for (int i = 0; i < STATS_BUCKETS / 2; i++) merged[i] = s->hist[2 * i] + s->hist[2 * i + 1];
+    memset(s->hist, 0, sizeof(s->hist));
+    int base = grow_down ? STATS_BUCKETS / 2 : 0;
+    memcpy(s->hist + base, merged, sizeof(merged));
+    if (grow_down) s->h_lo -= STATS_BUCKETS * s->h_width;
+    s->h_width *= 2.0f;
+}
+
+// 以首个样本为中心确定桶宽, 之前的样本 (都等于 first) 已计在中间桶
+static void hist_seed(RunningStat* s, float w) {
+    s->h_width = w;
+    s->h_lo = s->first - w * (STATS_BUCKETS / 2);
+    s->h_seeded = 1;
+}
+
+static void hist_add(RunningStat* s, float v) {
+    if (s->count == 1) {
+        s->first = v;
+        if (s->h_range > 0.0f) hist_seed(s, s->h_range / STATS_BUCKETS);
+    }
+    if (!s->h_seeded) {
+        // 量程未知: 等到出现第一个不同的值, 让它落在距中心 1/4 量程处
+        if (v == s->first) { s->hist[STATS_BUCKETS / 2]++; return; }
+        hist_seed(s, fabsf(v - s->first) / (STATS_BUCKETS / 4));
+    }
+    while (v < s->h_lo) hist_double(s, 1);
+    while (v >= s->h_lo + STATS_BUCKETS * s->h_width) hist_double(s, 0);
+
+    int b = (int)((v - s->h_lo) / s->h_width);
+    if (b < 0) b = 0;
+    if (b >= STATS_BUCKETS) b = STATS_BUCKETS - 1;
+    s->hist[b]++;
+}
+
+void Stats_Add(RunningStat* s, float v) {
+    if (!isfinite(v)) return;
+    if (s->count == UINT32_MAX) return; // 计数饱和后保持不变
+
+    s->count++;
+    double delta = v - s->mean;
+    s->mean += delta / s->count;
+    s->m2 += delta * (v - s->mean);
+    if (s->count == 1 || v < s->min) s->min = v;
+    if (s->count == 1 || v > s->max) s->max = v;
+    hist_add(s, v);
+}
+
+float Stats_Stddev(const RunningStat* s) {
+    if (s->count < 2) return 0.0f;
+    return (float)sqrt(s->m2 / (s->count - 1));
+}
@@ -0,0 +1,37 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+// --- 长时间运行统计 ---
+// 每个测量量一个累加器: Welford 在线均值/方差, 最值, 固定桶数直方图.
+// 内存固定, 每次更新常数时间. 直方图量程按需翻倍 (相邻桶两两合并),
+// 桶数不变, 因此运行多久都不会增长.
+
+#define STATS_BUCKETS 32 // 必须为偶数
+
+typedef struct {
+    uint32_t count;
+    double mean;
+    double m2;          // 偏差平方和 (Welford)
+    float min, max;
+
+    // 直方图: 覆盖 [h_lo, h_lo + STATS_BUCKETS * h_width)
+    float h_range;      // 预期取值范围, 决定初始桶宽; 0 表示未知
+    int h_seeded;       // 桶宽已确定 (未确定前样本全等于 first, 计在中间桶)
+    float first;
+    float h_lo;
+    float h_width;
+    uint32_t hist[STATS_BUCKETS];
+} RunningStat;
+
+// 清空统计并重建直方图; range 为预期取值范围 (例如整屏对应的电压/时间),
+// 初始桶宽取 range / STATS_BUCKETS. range 为 0 时按前几个样本的离散程度确定
+void Stats_Reset(RunningStat* s, float range);
+
+// 加入一个样本 (忽略非有限值)
+void Stats_Add(RunningStat* s, float v);
+
+float Stats_Stddev(const RunningStat* s);
+
+#endif
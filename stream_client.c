@@ -0,0 +1,103 @@
+// --- 数据流参考客户端 ---
+// 连接 scope_app 的数据流服务, 逐帧打印摘要, 用于本机测试
+// 用法:
+//   stream_client tcp [host] [port] [帧数]
+//   stream_client unix <path> [帧数]
+// 帧数为 0 或省略时一直接收
+#include "stream_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static uint32_t get_u16(const uint8_t* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8); }
+static uint32_t get_u32(const uint8_t* p) { return get_u16(p) | (get_u16(p + 2) << 16); }
+
+static int read_all(int fd, uint8_t* buf, int len) {
+    int got = 0;
+    while (got < len) {
+        ssize_t n = read(fd, buf + got, len - got);
+        if (n <= 0) return -1;
+        got += (int)n;
+    }
+    return 0;
+}
+
+static int connect_tcp(const char* host, int port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_aton(host, &addr.sin_addr) == 0) return -1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) { close(fd); return -1; }
+    return fd;
+}
+
+static int connect_unix(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) { close(fd); return -1; }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    int fd = -1;
+    long max_frames = 0;
+
+    if (argc >= 2 && strcmp(argv[1], "unix") == 0 && argc >= 3) {
+        fd = connect_unix(argv[2]);
+        if (argc >= 4) max_frames = atol(argv[3]);
+    } else if (argc >= 2 && strcmp(argv[1], "tcp") == 0) {
+        const char* host = (argc >= 3) ? argv[2] : "127.0.0.1";
+        int port = (argc >= 4) ? atoi(argv[3]) : 5025;
+        fd = connect_tcp(host, port);
+        if (argc >= 5) max_frames = atol(argv[4]);
+    } else {
+        fprintf(stderr, "usage: %s tcp [host] [port] [frames] | unix <path> [frames]\n", argv[0]);
+        return 2;
+    }
+    if (fd < 0) {
+        perror("connect");
+        return 1;
+    }
+
+    uint8_t hdr[STREAM_HEADER_SIZE];
+    uint8_t samples[STREAM_MAX_SAMPLES * 2];
+    uint32_t last_seq = 0;
+    long frames = 0, gaps = 0;
+
+    while (max_frames == 0 || frames < max_frames) {
+        if (read_all(fd, hdr, STREAM_HEADER_SIZE) != 0) break;
+        if (memcmp(hdr, STREAM_MAGIC, 4) != 0 || get_u16(hdr + 6) != STREAM_HEADER_SIZE) {
+            fprintf(stderr, "bad frame header\n");
+            break;
+        }
+        int n = (int)get_u16(hdr + 18);
+        if (n > STREAM_MAX_SAMPLES || read_all(fd, samples, n * 2) != 0) break;
+
+        uint32_t seq = get_u32(hdr + 8);
+        if (frames > 0 && seq != last_seq + 1) gaps++; // 服务端因本端太慢而跳过的帧
+        last_seq = seq;
+        frames++;
+
+        printf("#%u t=%ums tb=%u vb=%u n=%d min=%d max=%d mean=%d freq=%.3fHz s0=%u\n",
+               (unsigned)seq, (unsigned)get_u32(hdr + 12), hdr[16], hdr[17], n,
+               (int)get_u32(hdr + 20), (int)get_u32(hdr + 24), (int)get_u32(hdr + 28),
+               get_u32(hdr + 32) / 1000.0, n > 0 ? (unsigned)get_u16(samples) : 0u);
+    }
+
+    fprintf(stderr, "%ld frames, %ld gaps\n", frames, gaps);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include "stream_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// --- 共享帧缓冲 ---
+typedef struct {
+    int refcount; // 0 表示空闲
+    int len;
+    uint8_t data[STREAM_FRAME_MAX];
+} StreamFrame;
+
+// --- 客户端 ---
+typedef struct {
+    int fd;       // -1 表示空位
+    StreamFrame* queue[STREAM_CLIENT_QUEUE];
+    int q_head, q_count;
+    int offset;   // 队首帧已发送字节数
+    int skips;    // 连续跳帧数
+} StreamClient;
+
+static StreamFrame pool[STREAM_POOL_FRAMES];
+static StreamClient clients[STREAM_MAX_CLIENTS];
+static int listen_tcp = -1;
+static int listen_unix = -1;
+static char unix_path[108] = "";
+static int enabled = 0;
+static StreamStats stats;
+
+static void set_nonblock(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static void frame_release(StreamFrame* f) {
+    if (f && f->refcount > 0) f->refcount--;
+}
+
+static void client_drop(StreamClient* c) {
+    while (c->q_count > 0) {
+        frame_release(c->queue[c->q_head]);
+        c->q_head = (c->q_head + 1) % STREAM_CLIENT_QUEUE;
+        c->q_count--;
+    }
+    close(c->fd);
+    c->fd = -1;
+    stats.clients--;
+}
+
+static void put_u16(uint8_t* p, uint32_t v) { p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; }
+static void put_u32(uint8_t* p, uint32_t v) { put_u16(p, v & 0xFFFF); put_u16(p + 2, v >> 16); }
+
+static int open_tcp(void) {
+    const char* port_str = getenv("SCOPE_STREAM_PORT");
+    if (!port_str || !*port_str) return 0;
+    const char* bind_addr = getenv("SCOPE_STREAM_BIND");
+    if (!bind_addr || !*bind_addr) bind_addr = "127.0.0.1";
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)atoi(port_str));
+    if (inet_aton(bind_addr, &addr.sin_addr) == 0) return -1;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        close(fd);
+        return -1;
+    }
+    set_nonblock(fd);
+    listen_tcp = fd;
+    printf("Stream: listening on %s:%s\n", bind_addr, port_str);
+    return 0;
+}
+
+static int open_unix(void) {
+    const char* path = getenv("SCOPE_STREAM_SOCK");
+    if (!path || !*path) return 0;
+    if (strlen(path) >= sizeof(((struct sockaddr_un*)0)->sun_path)) return -1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    unlink(path); // 清理上次异常退出留下的套接字文件
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        close(fd);
+        return -1;
+    }
+    set_nonblock(fd);
+    listen_unix = fd;
+    strcpy(unix_path, path);
+    printf("Stream: listening on %s\n", path);
+    return 0;
+}
+
+int Stream_Init(void) {
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) clients[i].fd = -1;
+    memset(pool, 0, sizeof(pool));
+    memset(&stats, 0, sizeof(stats));
+
+    int ret = 0;
+    if (open_tcp() != 0) { fprintf(stderr, "Stream: TCP listen failed: %s\n", strerror(errno)); ret = -1; }
+    if (open_unix() != 0) { fprintf(stderr, "Stream: unix listen failed: %s\n", strerror(errno)); ret = -1; }
+    enabled = (listen_tcp >= 0 || listen_unix >= 0);
+    return ret;
+}
+
+static void accept_from(int lfd) {
+    if (lfd < 0) return;
+    for (;;) {
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) return;
+
+        StreamClient* slot = NULL;
+        for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0) { slot = &clients[i]; break; }
+        }
+        if (!slot) { close(fd); continue; }
+
+        set_nonblock(fd);
+        if (lfd == listen_tcp) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        memset(slot, 0, sizeof(*slot));
+        slot->fd = fd;
+        stats.clients++;
+    }
+}
+
+// 尽量把排队的帧写出去, 遇到 EAGAIN 立即返回
+static void client_flush(StreamClient* c) {
+    while (c->q_count > 0) {
+        StreamFrame* f = c->queue[c->q_head];
+        ssize_t n = send(c->fd, f->data + c->offset, f->len - c->offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return;
+            client_drop(c);
+            return;
+        }
+        c->offset += (int)n;
+        if (c->offset < f->len) return;
+
+        frame_release(f);
+        c->q_head = (c->q_head + 1) % STREAM_CLIENT_QUEUE;
+        c->q_count--;
+        c->offset = 0;
+    }
+}
+
+void Stream_Poll(void) {
+    if (!enabled) return;
+    accept_from(listen_tcp);
+    accept_from(listen_unix);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) client_flush(&clients[i]);
+    }
+}
+
+void Stream_Publish(const int* samples, int n, const StreamMeta* meta) {
+    if (!enabled || stats.clients == 0) return;
+    if (n > STREAM_MAX_SAMPLES) n = STREAM_MAX_SAMPLES;
+
+    StreamFrame* f = NULL;
+    for (int i = 0; i < STREAM_POOL_FRAMES; i++) {
+        if (pool[i].refcount == 0) { f = &pool[i]; break; }
+    }
+    if (!f) { stats.pool_exhausted++; return; }
+
+    // 1. 编码一次
+    uint8_t* p = f->data;
+    memcpy(p, STREAM_MAGIC, 4);
+    put_u16(p + 4, STREAM_VERSION);
+    put_u16(p + 6, STREAM_HEADER_SIZE);
+    put_u32(p + 8, meta->seq);
+    put_u32(p + 12, meta->timestamp_ms);
+    p[16] = (uint8_t)meta->time_div_idx;
+    p[17] = (uint8_t)meta->volt_div_idx;
+    put_u16(p + 18, (uint32_t)n);
+    put_u32(p + 20, (uint32_t)meta->min_mv);
+    put_u32(p + 24, (uint32_t)meta->max_mv);
+    put_u32(p + 28, (uint32_t)meta->mean_mv);
+    put_u32(p + 32, meta->freq_hz > 0.0f ? (uint32_t)(meta->freq_hz * 1000.0f) : 0);
+    uint8_t* d = p + STREAM_HEADER_SIZE;
+    for (int i = 0; i < n; i++) put_u16(d + i * 2, (uint32_t)samples[i]);
+    f->len = STREAM_HEADER_SIZE + n * 2;
+
+    // 2. 各客户端只持有引用; 发布者自己持有一份, 分发完再释放
+    f->refcount = 1;
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        StreamClient* c = &clients[i];
+        if (c->fd < 0) continue;
+        if (c->q_count >= STREAM_CLIENT_QUEUE) {
+            stats.skipped++;
+            if (++c->skips > STREAM_MAX_SKIPS) {
+                client_drop(c);
+                stats.dropped_clients++;
+            }
+            continue;
+        }
+        c->skips = 0;
+        c->queue[(c->q_head + c->q_count) % STREAM_CLIENT_QUEUE] = f;
+        c->q_count++;
+        f->refcount++;
+    }
+    frame_release(f);
+    stats.published++;
+
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) client_flush(&clients[i]);
+    }
+}
+
+void Stream_GetStats(StreamStats* out) {
+    *out = stats;
+}
+
+void Stream_Shutdown(void) {
+    if (!enabled) return;
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) client_drop(&clients[i]);
+    }
+    if (listen_tcp >= 0) close(listen_tcp);
+    if (listen_unix >= 0) close(listen_unix);
+    if (unix_path[0]) unlink(unix_path);
+    listen_tcp = listen_unix = -1;
+    unix_path[0] = '\0';
+    printf("Stream: %u frames published, %u skipped, %u slow clients dropped\n",
+           (unsigned)stats.published, (unsigned)stats.skipped, (unsigned)stats.dropped_clients);
+    enabled = 0;
+}
@@ -0,0 +1,76 @@
+#ifndef STREAM_SERVER_H
+#define STREAM_SERVER_H
+
+#include <stdint.h>
+
+// --- 数据流服务 ---
+// 把解码后的每帧波形与测量值推送给任意数量的订阅端 (TCP 和/或 Unix 域套接字).
+// 每帧只编码一次, 放进带引用计数的共享缓冲, 各客户端只持有指针, 不逐个拷贝.
+// 发送全部非阻塞: 慢客户端的队列满了就跳过该帧, 连续跳过太多直接断开,
+// 绝不反压采集主循环.
+//
+// 启用方式 (环境变量, 都不设则不启用):
+//   SCOPE_STREAM_PORT  TCP 端口
+//   SCOPE_STREAM_BIND  TCP 监听地址, 默认 127.0.0.1
+//   SCOPE_STREAM_SOCK  Unix 域套接字路径
+
+// --- 可调参数 ---
+#define STREAM_MAX_CLIENTS   8
+#define STREAM_CLIENT_QUEUE  4  // 每个客户端最多排队的帧数
+// 共享帧缓冲个数: 所有客户端队列都排满时再加正在发布的一帧, 缓冲永不耗尽,
+// 停滞的客户端只会占满自己的队列并按跳帧计数被断开, 不会拖住其它客户端
+#define STREAM_POOL_FRAMES   (STREAM_MAX_CLIENTS * STREAM_CLIENT_QUEUE + 1)
+#define STREAM_MAX_SKIPS     30 // 连续跳帧超过此数断开客户端
+
+// --- 线上格式 (全部小端) ---
+// 帧头 STREAM_HEADER_SIZE 字节, 随后 n_samples 个 uint16 采样 (mV)
+//   0  char[4]  "SCPF"
+//   4  uint16   版本 (STREAM_VERSION)
+//   6  uint16   帧头长度
+//   8  uint32   帧序号
+//   12 uint32   时间戳 (ms, SDL_GetTicks)
+//   16 uint8    time_div_idx
+//   17 uint8    volt_div_idx
+//   18 uint16   n_samples
+//   20 int32    min_mv
+//   24 int32    max_mv
+//   28 int32    mean_mv
+//   32 uint32   频率 (mHz, 0 表示未测出)
+#define STREAM_MAGIC        "SCPF"
+#define STREAM_VERSION      1
+#define STREAM_HEADER_SIZE  36
+#define STREAM_MAX_SAMPLES  320
+#define STREAM_FRAME_MAX    (STREAM_HEADER_SIZE + STREAM_MAX_SAMPLES * 2)
+
+typedef struct {
+    uint32_t seq;
+    uint32_t timestamp_ms;
+    int time_div_idx;
+    int volt_div_idx;
+    int min_mv, max_mv, mean_mv;
+    float freq_hz;
+} StreamMeta;
+
+typedef struct {
+    uint32_t clients;         // 当前连接数
+    uint32_t published;       // 已发布帧数
+    uint32_t pool_exhausted;  // 共享缓冲耗尽而未发布的帧数
+    uint32_t skipped;         // 因客户端队列满而跳过的 (客户端, 帧) 数
+    uint32_t dropped_clients; // 被断开的慢客户端数
+} StreamStats;
+
+// 按环境变量启动监听, 未配置时什么也不做
+// 返回: 0 成功或未启用, -1 配置了但监听失败
+int Stream_Init(void);
+
+// 主循环每轮调用: 接受新连接, 继续发送排队数据
+void Stream_Poll(void);
+
+// 发布一帧 (不阻塞)
+void Stream_Publish(const int* samples, int n, const StreamMeta* meta);
+
+void Stream_GetStats(StreamStats* out);
+
+void Stream_Shutdown(void);
+
+#endif
@@ -0,0 +1,9 @@
+#include "time_util.h"
+#include <stddef.h>
+#include <sys/time.h>
+
+uint32_t Time_NowUs(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t)(tv.tv_sec * 1000000u + tv.tv_usec);
+}
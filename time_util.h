@@ -0,0 +1,10 @@
+#ifndef TIME_UTIL_H
+#define TIME_UTIL_H
+#include <stdint.h>
+
+// --- 微秒计时 ---
+// 不依赖 SDL, 主程序与离线分析工具共用. 返回值约 71 分钟回绕一次,
+// 只用来求时间差 (无符号相减在回绕时仍然正确)
+uint32_t Time_NowUs(void);
+
+#endif
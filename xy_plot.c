@@ -0,0 +1,80 @@
+#include "xy_plot.h"
+#include <string.h>
+
+#define XY_HIT 96 // 每次命中增加的亮度, 饱和到 255, 轨迹经过越多越亮
+
+void Xy_Init(XyPlot* xy, uint8_t r, uint8_t g, uint8_t b) {
+    for (int v = 0; v < 256; v++) {
+        // 留一个底亮度, 衰减到末尾的点仍可见
+        int k = 48 + v * 207 / 255;
+        int rr = r * k / 255, gg = g * k / 255, bb = b * k / 255;
+        xy->palette[v] = (uint16_t)(((rr & 0xF8) << 8) | ((gg & 0xFC) << 3) | (bb >> 3));
+    }
+    xy->built_scale_fp = 0; // 首次 Xy_SetScale 时生成查表
+    Xy_Clear(xy);
+}
+
+void Xy_Clear(XyPlot* xy) {
+    memset(xy->glow, 0, sizeof(xy->glow));
+}
+
+int Xy_SetScale(XyPlot* xy, int32_t scale_fp, int zero_x, int zero_y) {
+    if (scale_fp == xy->built_scale_fp && zero_x == xy->built_zero_x && zero_y == xy->built_zero_y) return 0;
+    for (int k = 0; k < XY_TABLE_SIZE; k++) {
+        // 取每项区间的中点换算
+        int64_t mv = ((int64_t)k << XY_TABLE_SHIFT) + (1 << (XY_TABLE_SHIFT - 1));
+        int off = (int)((mv * scale_fp) >> 16);
+        int x = zero_x + off;
+        int y = zero_y - off;
+        xy->map_x[k] = (x >= 0 && x < XY_W) ? (int16_t)x : -1;
+        xy->map_y[k] = (y >= 0 && y < XY_H) ? (int16_t)y : -1;
+    }
+    xy->built_scale_fp = scale_fp;
+    xy->built_zero_x = zero_x;
+    xy->built_zero_y = zero_y;
+    Xy_Clear(xy); // 旧比例下的余辉已不对应新坐标
+    return 1;
+}
+
+void Xy_Accumulate(XyPlot* xy, const int* xs, const int* ys, int n) {
+    uint8_t* __restrict glow = xy->glow;
+    // 整屏衰减: 定长无分支循环, 可被编译器向量化
+    for (int i = 0; i < XY_H * XY_W; i++) glow[i] = (uint8_t)((glow[i] * XY_DECAY) >> 8);
+
+    const int16_t* map_x = xy->map_x;
+    const int16_t* map_y = xy->map_y;
+    for (int i = 0; i < n; i++) {
+        unsigned kx = (unsigned)xs[i] >> XY_TABLE_SHIFT;
+        unsigned ky = (unsigned)ys[i] >> XY_TABLE_SHIFT;
+        if (kx >= XY_TABLE_SIZE || ky >= XY_TABLE_SIZE) continue;
+        int x = map_x[kx], y = map_y[ky];
+        if ((x | y) < 0) continue; // 任一轴越界
+        uint8_t* p = &glow[y * XY_W + x];
+        *p = (*p > 255 - XY_HIT) ? 255 : *p + XY_HIT;
+    }
+}
+
+void Xy_Render(const XyPlot* xy, uint16_t* pixels, int pitch, int* top, int* bot) {
+    *top = XY_H;
+    *bot = -1;
+    for (int y = 0; y < XY_H; y++) {
+        const uint8_t* row = &xy->glow[y * XY_W];
+        uint16_t* out = &pixels[y * pitch];
+        int lit = 0;
+        for (int x = 0; x < XY_W; x += 8) {
+            // 余辉通常很稀疏, 8 个像素一起判断, 全暗直接跳过
+            uint64_t chunk;
+            memcpy(&chunk, row + x, 8);
+            if (!chunk) continue;
+            for (int k = x; k < x + 8; k++) {
+                uint8_t v = row[k];
+                if (v) out[k] = xy->palette[v];
+            }
+            lit = 1;
+        }
+        if (lit) {
+            if (y < *top) *top = y;
+            *bot = y;
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef XY_PLOT_H
+#define XY_PLOT_H
+
+#include <stdint.h>
+
+// --- XY (李萨如) 显示 ---
+// 以一路信号为 X、另一路 (或同一路延时后的副本) 为 Y 打点, 点累积在 8 位亮度缓冲里逐帧衰减.
+// mV -> 屏幕坐标用查表完成, 表只在档位/零点变化时重建, 打点循环里没有乘除和浮点.
+
+#define XY_W           320   // 须为 8 的倍数 (Xy_Render 按 8 像素跳过暗区)
+#define XY_H           240
+#define XY_TABLE_SHIFT 3                       // 查表精度: 每 8 mV 一项
+#define XY_TABLE_SIZE  (65536 >> XY_TABLE_SHIFT) // 覆盖 uint16 采样的全范围
+#define XY_DECAY       224                     // 每帧亮度乘以 XY_DECAY/256
+
+typedef struct {
+    uint8_t glow[XY_H * XY_W];        // 亮度缓冲, 0 为熄灭
+    int16_t map_x[XY_TABLE_SIZE];     // mV 对应的屏幕 x, 越界为 -1
+    int16_t map_y[XY_TABLE_SIZE];     // mV 对应的屏幕 y, 越界为 -1
+    uint16_t palette[256];            // 亮度 -> RGB565
+    int built_scale_fp, built_zero_x, built_zero_y; // 查表对应的比例与零点
+} XyPlot;
+
+// 生成亮度调色板 (r/g/b 为最亮时的颜色) 并清空缓冲
+void Xy_Init(XyPlot* xy, uint8_t r, uint8_t g, uint8_t b);
+
+void Xy_Clear(XyPlot* xy);
+
+// 按比例 (每 mV 的像素数, 16.16 定点, 与 Mask_ToScreen 一致) 与两轴零点重建查表;
+// 参数有变化时清空缓冲, 返回 1, 未变化返回 0
+int Xy_SetScale(XyPlot* xy, int32_t scale_fp, int zero_x, int zero_y);
+
+// 衰减已有亮度, 再把 (xs[i], ys[i]) 共 n 个点打到缓冲上
+void Xy_Accumulate(XyPlot* xy, const int* xs, const int* ys, int n);
+
+// 把亮度缓冲画到 RGB565 像素区 (pitch 以像素计), 熄灭处不写;
+// top/bot 返回有亮点的行范围 (没有时 top > bot)
+void Xy_Render(const XyPlot* xy, uint16_t* pixels, int pitch, int* top, int* bot);
+
+#endif